@@ -0,0 +1,416 @@
+#pragma once
+#include "serialization.h"
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum class AsyncBackend {
+	Auto,  // io_uring, если ядро его поддерживает, иначе синхронные pread/pwrite
+	Sync,  // Всегда синхронные pread/pwrite
+};
+
+// Очередь асинхронного чтения и записи файлов поверх io_uring, работающая через системные вызовы
+// без liburing. Одновременно выполняется не более queue_depth операций; при заполненной очереди
+// Submit* ждёт завершения одной из них. Обработчики завершения вызываются из Poll, WaitAll
+// и Submit* в потоке, владеющем очередью. При синхронном режиме операция выполняется сразу,
+// а обработчик вызывается до возврата из Submit*
+class AsyncFileIo {
+public:
+	// Получает число переданных байтов или -errno
+	using Callback = std::function<void(ssize_t result)>;
+
+	explicit AsyncFileIo(unsigned queue_depth = 32, AsyncBackend backend = AsyncBackend::Auto)
+			: requests_(std::max(queue_depth, 1u))
+	{
+		for (size_t i = requests_.Size(); i > 0; --i) {
+			free_slots_.PushBack(i - 1);
+		}
+		if (backend == AsyncBackend::Auto) {
+			SetupRing(static_cast<unsigned>(requests_.Size()));
+		}
+	}
+
+	AsyncFileIo(const AsyncFileIo&) = delete;
+
+	AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+	~AsyncFileIo() {
+		try {
+			WaitAll();
+		} catch (...) {
+		}
+		if (sq_entries_ != nullptr) {
+			::munmap(sq_entries_, sq_entries_size_);
+		}
+		if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+			::munmap(cq_ring_, cq_ring_size_);
+		}
+		if (sq_ring_ != nullptr) {
+			::munmap(sq_ring_, sq_ring_size_);
+		}
+		if (ring_fd_ >= 0) {
+			::close(ring_fd_);
+		}
+	}
+
+	bool UsesUring() const noexcept {
+		return ring_fd_ >= 0;
+	}
+
+	size_t QueueDepth() const noexcept {
+		return requests_.Size();
+	}
+
+	size_t InFlight() const noexcept {
+		return requests_.Size() - free_slots_.Size();
+	}
+
+	void SubmitWrite(int fd, const void* data, size_t size, uint64_t offset, Callback callback) {
+		Submit({fd, const_cast<void*>(data), size, offset, true, 0, std::move(callback)});
+	}
+
+	void SubmitRead(int fd, void* data, size_t size, uint64_t offset, Callback callback) {
+		Submit({fd, data, size, offset, false, 0, std::move(callback)});
+	}
+
+	// Обрабатывает уже готовые завершения, не блокируясь. Возвращает число завершённых операций
+	size_t Poll() {
+		return ReapCompletions();
+	}
+
+	// Дожидается завершения всех отправленных операций
+	void WaitAll() {
+		while (InFlight() != 0) {
+			WaitForCompletion();
+		}
+	}
+
+private:
+	struct Request {
+		int fd = -1;
+		void* data = nullptr;
+		size_t size = 0;
+		uint64_t offset = 0;
+		bool is_write = false;
+		size_t done = 0;
+		Callback callback;
+	};
+
+	void SetupRing(unsigned entries) noexcept {
+		io_uring_params params{};
+		const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+		if (fd < 0) {
+			return;
+		}
+		if (!SupportsReadWrite(fd)) {
+			::close(fd);
+			return;
+		}
+		sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_mmap) {
+			sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+		}
+		sq_ring_ = MapRing(fd, sq_ring_size_, IORING_OFF_SQ_RING);
+		cq_ring_ = single_mmap ? sq_ring_ : MapRing(fd, cq_ring_size_, IORING_OFF_CQ_RING);
+		sq_entries_size_ = params.sq_entries * sizeof(io_uring_sqe);
+		sq_entries_ = MapRing(fd, sq_entries_size_, IORING_OFF_SQES);
+		if (sq_ring_ == nullptr || cq_ring_ == nullptr || sq_entries_ == nullptr) {
+			if (sq_entries_ != nullptr) {
+				::munmap(sq_entries_, sq_entries_size_);
+			}
+			if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+				::munmap(cq_ring_, cq_ring_size_);
+			}
+			if (sq_ring_ != nullptr) {
+				::munmap(sq_ring_, sq_ring_size_);
+			}
+			sq_ring_ = cq_ring_ = sq_entries_ = nullptr;
+			::close(fd);
+			return;
+		}
+		auto* sq = static_cast<char*>(sq_ring_);
+		auto* cq = static_cast<char*>(cq_ring_);
+		sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		ring_fd_ = fd;
+	}
+
+	// IORING_OP_READ и IORING_OP_WRITE появились в ядре 5.6 вместе с IORING_REGISTER_PROBE
+	static bool SupportsReadWrite(int fd) noexcept {
+		const size_t OPS_COUNT = 256;
+		const size_t probe_size = sizeof(io_uring_probe) + OPS_COUNT * sizeof(io_uring_probe_op);
+		std::unique_ptr<char[]> buffer(new (std::nothrow) char[probe_size]());
+		if (buffer == nullptr) {
+			return false;
+		}
+		auto* probe = reinterpret_cast<io_uring_probe*>(buffer.get());
+		if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, OPS_COUNT) < 0) {
+			return false;
+		}
+		const auto is_supported = [probe](unsigned op) {
+			return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+		};
+		return is_supported(IORING_OP_READ) && is_supported(IORING_OP_WRITE);
+	}
+
+	static void* MapRing(int fd, size_t size, off_t offset) noexcept {
+		void* ring = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+		return ring == MAP_FAILED ? nullptr : ring;
+	}
+
+	void Submit(Request request) {
+		if (!UsesUring()) {
+			const ssize_t result = Transfer(request);
+			request.callback(result);
+			return;
+		}
+		while (free_slots_.Size() == 0) {
+			WaitForCompletion();
+		}
+		const size_t slot = free_slots_[free_slots_.Size() - 1];
+		free_slots_.PopBack();
+		requests_[slot] = std::move(request);
+		Enqueue(slot);
+	}
+
+	// Синхронный путь: дописывает или дочитывает запрос целиком
+	static ssize_t Transfer(const Request& request) noexcept {
+		size_t done = 0;
+		while (done < request.size) {
+			auto* data = static_cast<char*>(request.data) + done;
+			const auto offset = static_cast<off_t>(request.offset + done);
+			const ssize_t result = request.is_write ? ::pwrite(request.fd, data, request.size - done, offset)
+			                                        : ::pread(request.fd, data, request.size - done, offset);
+			if (result < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return -errno;
+			}
+			if (result == 0) {
+				break;
+			}
+			done += static_cast<size_t>(result);
+		}
+		return static_cast<ssize_t>(done);
+	}
+
+	// Ставит в очередь оставшуюся часть запроса из слота slot и сообщает о ней ядру
+	void Enqueue(size_t slot) {
+		const Request& request = requests_[slot];
+		const unsigned tail = *sq_tail_;
+		const unsigned index = tail & sq_mask_;
+		io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sq_entries_)[index];
+		sqe = io_uring_sqe{};
+		sqe.opcode = request.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+		sqe.fd = request.fd;
+		sqe.addr = reinterpret_cast<uint64_t>(static_cast<char*>(request.data) + request.done);
+		sqe.len = static_cast<uint32_t>(std::min<size_t>(request.size - request.done, MAX_TRANSFER));
+		sqe.off = request.offset + request.done;
+		sqe.user_data = slot;
+		sq_array_[index] = index;
+		__atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+		Enter(1, 0);
+	}
+
+	void Enter(unsigned to_submit, unsigned min_complete) {
+		const unsigned flags = min_complete != 0 ? IORING_ENTER_GETEVENTS : 0;
+		while (::syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0) < 0) {
+			if (errno != EINTR) {
+				throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+			}
+		}
+	}
+
+	void WaitForCompletion() {
+		if (ReapCompletions() == 0) {
+			Enter(0, 1);
+			ReapCompletions();
+		}
+	}
+
+	size_t ReapCompletions() {
+		if (!UsesUring()) {
+			return 0;
+		}
+		size_t completed = 0;
+		unsigned head = *cq_head_;
+		while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+			const io_uring_cqe cqe = cqes_[head & cq_mask_];
+			__atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+			completed += Complete(static_cast<size_t>(cqe.user_data), cqe.res);
+		}
+		return completed;
+	}
+
+	// Обрабатывает результат очередной части запроса. Возвращает 1, если запрос завершён
+	size_t Complete(size_t slot, int result) {
+		Request& request = requests_[slot];
+		if (result > 0) {
+			request.done += static_cast<size_t>(result);
+		}
+		// Короткие передачи и прерванные системные вызовы дозапрашиваются в том же слоте
+		const bool retry = (result > 0 && request.done < request.size) || result == -EINTR || result == -EAGAIN;
+		if (retry) {
+			Enqueue(slot);
+			return 0;
+		}
+		Callback callback = std::move(request.callback);
+		const ssize_t outcome = result < 0 ? result : static_cast<ssize_t>(request.done);
+		request = Request{};
+		free_slots_.PushBack(slot);
+		callback(outcome);
+		return 1;
+	}
+
+	// Максимальный размер одной операции ограничен полем len в io_uring_sqe
+	static constexpr size_t MAX_TRANSFER = 1u << 30;
+
+	SimpleVector<Request> requests_;
+	SimpleVector<size_t> free_slots_;
+
+	int ring_fd_ = -1;
+	void* sq_ring_ = nullptr;
+	void* cq_ring_ = nullptr;
+	void* sq_entries_ = nullptr;
+	size_t sq_ring_size_ = 0;
+	size_t cq_ring_size_ = 0;
+	size_t sq_entries_size_ = 0;
+	unsigned* sq_tail_ = nullptr;
+	unsigned sq_mask_ = 0;
+	unsigned* sq_array_ = nullptr;
+	unsigned* cq_head_ = nullptr;
+	unsigned* cq_tail_ = nullptr;
+	unsigned cq_mask_ = 0;
+	io_uring_cqe* cqes_ = nullptr;
+};
+
+namespace detail {
+
+	// Общее состояние одной асинхронной операции над вектором, разбитой на части
+	struct AsyncVectorTransfer {
+		VectorFileHeader header{};
+		size_t pending = 0;
+		std::error_code error;
+		std::function<void()> on_finish;
+
+		std::function<void(ssize_t)> MakePartCallback(size_t expected, const std::shared_ptr<AsyncVectorTransfer>& self) {
+			return [self, expected](ssize_t result) {
+				if (!self->error) {
+					if (result < 0) {
+						self->error = std::error_code(static_cast<int>(-result), std::generic_category());
+					} else if (static_cast<size_t>(result) != expected) {
+						self->error = std::make_error_code(std::errc::io_error);
+					}
+				}
+				if (--self->pending == 0) {
+					self->on_finish();
+				}
+			};
+		}
+	};
+
+	// Разбивает [0, size) на части по chunk_size байт и отправляет каждую через submit(offset, length)
+	template <typename Submit>
+	void SubmitChunks(size_t size, size_t chunk_size, Submit submit) {
+		for (size_t offset = 0; offset < size; offset += chunk_size) {
+			submit(offset, std::min(chunk_size, size - offset));
+		}
+	}
+
+	inline size_t AlignChunkSize(size_t chunk_size) noexcept {
+		const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return std::max(page, chunk_size / page * page);
+	}
+
+}  // namespace detail
+
+// Асинхронно сохраняет вектор в файл fd в формате Save, разбивая буфер на части по chunk_size байт
+// (округляется до кратного размеру страницы). on_complete вызывается один раз после записи всех частей.
+// До этого момента вектор нельзя изменять или уничтожать
+template <typename T>
+void AsyncSave(AsyncFileIo& io, int fd, const SimpleVector<T>& vector,
+               std::function<void(std::error_code)> on_complete, size_t chunk_size = 1 << 20) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be saved as raw bytes");
+	auto transfer = std::make_shared<detail::AsyncVectorTransfer>();
+	transfer->header = MakeVectorFileHeader(vector.begin(), vector.Size());
+	const size_t bytes = vector.Size() * sizeof(T);
+	chunk_size = detail::AlignChunkSize(chunk_size);
+	transfer->pending = 1 + (bytes + chunk_size - 1) / chunk_size;
+	transfer->on_finish = [transfer_ptr = transfer.get(), on_complete = std::move(on_complete)] {
+		on_complete(transfer_ptr->error);
+	};
+
+	io.SubmitWrite(fd, &transfer->header, sizeof(VectorFileHeader), 0,
+	               transfer->MakePartCallback(sizeof(VectorFileHeader), transfer));
+	const auto* data = reinterpret_cast<const char*>(vector.begin());
+	detail::SubmitChunks(bytes, chunk_size, [&](size_t offset, size_t length) {
+		io.SubmitWrite(fd, data + offset, length, sizeof(VectorFileHeader) + offset,
+		               transfer->MakePartCallback(length, transfer));
+	});
+}
+
+// Асинхронно загружает в пустой вектор target файл формата Save. Заголовок читается синхронно,
+// буфер — частями по chunk_size байт прямо в неинициализированную память вектора.
+// on_complete вызывается после чтения всех частей и проверки контрольной суммы.
+// До этого момента target нельзя использовать
+template <typename T>
+void AsyncLoad(AsyncFileIo& io, int fd, SimpleVector<T>& target,
+               std::function<void(std::error_code)> on_complete, size_t chunk_size = 1 << 20) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be loaded from raw bytes");
+	assert(target.Size() == 0);
+	auto transfer = std::make_shared<detail::AsyncVectorTransfer>();
+	if (::pread(fd, &transfer->header, sizeof(VectorFileHeader), 0) != sizeof(VectorFileHeader)) {
+		throw SerializationError("Failed to read SimpleVector header");
+	}
+	ValidateVectorFileHeader<T>(transfer->header);
+	// Число элементов из заголовка сверяется с размером файла до выделения буфера
+	struct stat file_stat;
+	if (::fstat(fd, &file_stat) != 0) {
+		throw std::system_error(errno, std::generic_category(), "fstat");
+	}
+	const auto file_size = static_cast<uint64_t>(file_stat.st_size);
+	ValidateVectorPayloadSize<T>(transfer->header,
+	                             file_size > sizeof(VectorFileHeader) ? file_size - sizeof(VectorFileHeader) : 0);
+	const auto count = static_cast<size_t>(transfer->header.count);
+	const size_t bytes = count * sizeof(T);
+	T* buffer = target.AppendUninitialized(count);
+	chunk_size = detail::AlignChunkSize(chunk_size);
+	transfer->pending = (bytes + chunk_size - 1) / chunk_size;
+	transfer->on_finish = [transfer_ptr = transfer.get(), buffer, bytes, on_complete = std::move(on_complete)] {
+		if (!transfer_ptr->error && ComputeChecksum(buffer, bytes) != transfer_ptr->header.checksum) {
+			transfer_ptr->error = std::make_error_code(std::errc::illegal_byte_sequence);
+		}
+		on_complete(transfer_ptr->error);
+	};
+	if (transfer->pending == 0) {
+		transfer->on_finish();
+		return;
+	}
+
+	auto* data = reinterpret_cast<char*>(buffer);
+	detail::SubmitChunks(bytes, chunk_size, [&](size_t offset, size_t length) {
+		io.SubmitRead(fd, data + offset, length, sizeof(VectorFileHeader) + offset,
+		              transfer->MakePartCallback(length, transfer));
+	});
+}
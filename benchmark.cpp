@@ -0,0 +1,656 @@
+#include "benchmark.h"
+#include "simple_vector.h"
+#include "async_io.h"
+#include "dict_vector.h"
+#include "encoded_vector.h"
+#include "frozen_vector.h"
+#include "incremental_vector.h"
+#include "preallocating_vector.h"
+#include "latency_histogram.h"
+#include "vector_io.h"
+#include "test_objects.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace {
+
+	// Единый интерфейс к SimpleVector и std::vector, чтобы сравнивать их одним и тем же кодом
+	template <typename Vector>
+	struct VectorOps;
+
+	template <typename T>
+	struct VectorOps<SimpleVector<T>> {
+		static constexpr std::string_view NAME = "SimpleVector"sv;
+
+		static void PushBack(SimpleVector<T>& v, const T& value) {
+			v.PushBack(value);
+		}
+		template <typename... Args>
+		static void EmplaceBack(SimpleVector<T>& v, Args&&... args) {
+			v.EmplaceBack(std::forward<Args>(args)...);
+		}
+		static void Reserve(SimpleVector<T>& v, size_t capacity) {
+			v.Reserve(capacity);
+		}
+		static void Insert(SimpleVector<T>& v, size_t index, const T& value) {
+			v.Insert(v.cbegin() + index, value);
+		}
+		static void Erase(SimpleVector<T>& v, size_t index) {
+			v.Erase(v.cbegin() + index);
+		}
+		static size_t Size(const SimpleVector<T>& v) {
+			return v.Size();
+		}
+		static const T* Data(const SimpleVector<T>& v) {
+			return v.begin();
+		}
+	};
+
+	template <typename T>
+	struct VectorOps<std::vector<T>> {
+		static constexpr std::string_view NAME = "std::vector"sv;
+
+		static void PushBack(std::vector<T>& v, const T& value) {
+			v.push_back(value);
+		}
+		template <typename... Args>
+		static void EmplaceBack(std::vector<T>& v, Args&&... args) {
+			v.emplace_back(std::forward<Args>(args)...);
+		}
+		static void Reserve(std::vector<T>& v, size_t capacity) {
+			v.reserve(capacity);
+		}
+		static void Insert(std::vector<T>& v, size_t index, const T& value) {
+			v.insert(v.cbegin() + static_cast<std::ptrdiff_t>(index), value);
+		}
+		static void Erase(std::vector<T>& v, size_t index) {
+			v.erase(v.cbegin() + static_cast<std::ptrdiff_t>(index));
+		}
+		static size_t Size(const std::vector<T>& v) {
+			return v.size();
+		}
+		static const T* Data(const std::vector<T>& v) {
+			return v.data();
+		}
+	};
+
+	template <typename T>
+	struct ElementTraits;
+
+	template <>
+	struct ElementTraits<int> {
+		static constexpr std::string_view NAME = "int"sv;
+		static int Make(size_t i) {
+			return static_cast<int>(i);
+		}
+		template <typename Vector>
+		static void Emplace(Vector& v, size_t i) {
+			VectorOps<Vector>::EmplaceBack(v, static_cast<int>(i));
+		}
+	};
+
+	// Строки длиннее буфера SSO, чтобы копирование обращалось к куче
+	template <>
+	struct ElementTraits<std::string> {
+		static constexpr std::string_view NAME = "string"sv;
+		static std::string Make(size_t i) {
+			return std::string(32, static_cast<char>('a' + i % 26));
+		}
+		template <typename Vector>
+		static void Emplace(Vector& v, size_t i) {
+			VectorOps<Vector>::EmplaceBack(v, size_t{32}, static_cast<char>('a' + i % 26));
+		}
+	};
+
+	template <>
+	struct ElementTraits<Obj> {
+		static constexpr std::string_view NAME = "Obj"sv;
+		static Obj Make(size_t i) {
+			return Obj(static_cast<int>(i));
+		}
+		template <typename Vector>
+		static void Emplace(Vector& v, size_t i) {
+			VectorOps<Vector>::EmplaceBack(v, static_cast<int>(i), "Ivan"s);
+		}
+	};
+
+	template <>
+	struct ElementTraits<TestObj> {
+		static constexpr std::string_view NAME = "TestObj"sv;
+		static TestObj Make(size_t) {
+			return TestObj{};
+		}
+		template <typename Vector>
+		static void Emplace(Vector& v, size_t) {
+			VectorOps<Vector>::EmplaceBack(v);
+		}
+	};
+
+	template <typename Vector>
+	Vector MakeFilled(size_t size) {
+		using T = std::remove_const_t<std::remove_reference_t<decltype(*VectorOps<Vector>::Data(std::declval<Vector>()))>>;
+		Vector v;
+		VectorOps<Vector>::Reserve(v, size);
+		for (size_t i = 0; i < size; ++i) {
+			VectorOps<Vector>::PushBack(v, ElementTraits<T>::Make(i));
+		}
+		return v;
+	}
+
+	template <typename Vector>
+	struct CopyState {
+		Vector source;
+		Vector target;
+	};
+
+	template <typename T, typename Vector>
+	void RunCoreBenchmarks(BenchmarkRunner& runner) {
+		using Ops = VectorOps<Vector>;
+		const size_t SIZE = 10'000;
+		const size_t BASE_SIZE = 1'000;
+		const size_t EDITS = 100;
+		const std::string prefix = std::string(Ops::NAME) + "<" + std::string(ElementTraits<T>::NAME) + ">/";
+
+		const T value = ElementTraits<T>::Make(42);
+		runner.Run(prefix + "PushBack", SIZE, SIZE * sizeof(T), [&] {
+			Vector v;
+			for (size_t i = 0; i < SIZE; ++i) {
+				Ops::PushBack(v, value);
+			}
+			DoNotOptimize(Ops::Data(v));
+		});
+		runner.Run(prefix + "EmplaceBack", SIZE, SIZE * sizeof(T), [&] {
+			Vector v;
+			for (size_t i = 0; i < SIZE; ++i) {
+				ElementTraits<T>::Emplace(v, i);
+			}
+			DoNotOptimize(Ops::Data(v));
+		});
+		runner.Run(prefix + "PushBack after Reserve", SIZE, SIZE * sizeof(T), [&] {
+			Vector v;
+			Ops::Reserve(v, SIZE);
+			for (size_t i = 0; i < SIZE; ++i) {
+				Ops::PushBack(v, value);
+			}
+			DoNotOptimize(Ops::Data(v));
+		});
+		// Перенос SIZE элементов в буфер вдвое большей ёмкости
+		runner.RunWithSetup(prefix + "Reserve (relocate)", SIZE, SIZE * sizeof(T), [&] {
+			return MakeFilled<Vector>(SIZE);
+		}, [&](Vector& v) {
+			Ops::Reserve(v, SIZE * 2);
+			DoNotOptimize(Ops::Data(v));
+		});
+
+		const std::pair<std::string_view, double> positions[] = {{"front"sv, 0.0}, {"middle"sv, 0.5}, {"back"sv, 1.0}};
+		for (const auto& [where, fraction] : positions) {
+			runner.RunWithSetup(prefix + "Insert " + std::string(where), EDITS, 0, [&] {
+				return MakeFilled<Vector>(BASE_SIZE);
+			}, [&, fraction = fraction](Vector& v) {
+				for (size_t i = 0; i < EDITS; ++i) {
+					Ops::Insert(v, static_cast<size_t>(static_cast<double>(Ops::Size(v)) * fraction), value);
+				}
+				DoNotOptimize(Ops::Data(v));
+			});
+			// Вставка в заполненный вектор переносит все элементы вокруг нового
+			runner.RunWithSetup(prefix + "Insert " + std::string(where) + " (full)", 1, SIZE * sizeof(T), [&] {
+				return MakeFilled<Vector>(SIZE);
+			}, [&, fraction = fraction](Vector& v) {
+				Ops::Insert(v, static_cast<size_t>(static_cast<double>(SIZE) * fraction), value);
+				DoNotOptimize(Ops::Data(v));
+			});
+			runner.RunWithSetup(prefix + "Erase " + std::string(where), EDITS, 0, [&] {
+				return MakeFilled<Vector>(BASE_SIZE);
+			}, [&, fraction = fraction](Vector& v) {
+				for (size_t i = 0; i < EDITS; ++i) {
+					Ops::Erase(v, static_cast<size_t>(static_cast<double>(Ops::Size(v) - 1) * fraction));
+				}
+				DoNotOptimize(Ops::Data(v));
+			});
+		}
+
+		runner.RunWithSetup(prefix + "Copy", SIZE, SIZE * sizeof(T), [&] {
+			return CopyState<Vector>{MakeFilled<Vector>(SIZE), {}};
+		}, [](CopyState<Vector>& state) {
+			state.target = Vector(state.source);
+			DoNotOptimize(Ops::Data(state.target));
+		});
+		// Присваивание вектору того же размера переиспользует его буфер
+		runner.RunWithSetup(prefix + "Copy assign (same size)", SIZE, SIZE * sizeof(T), [&] {
+			return CopyState<Vector>{MakeFilled<Vector>(SIZE), MakeFilled<Vector>(SIZE)};
+		}, [](CopyState<Vector>& state) {
+			state.target = state.source;
+			DoNotOptimize(Ops::Data(state.target));
+		});
+		runner.RunWithSetup(prefix + "Move", 1, 0, [&] {
+			return CopyState<Vector>{MakeFilled<Vector>(SIZE), {}};
+		}, [](CopyState<Vector>& state) {
+			state.target = std::move(state.source);
+			DoNotOptimize(Ops::Data(state.target));
+		});
+	}
+
+	template <typename T>
+	void RunCoreBenchmarks(BenchmarkRunner& runner) {
+		RunCoreBenchmarks<T, SimpleVector<T>>(runner);
+		RunCoreBenchmarks<T, std::vector<T>>(runner);
+	}
+
+	// Временный файл, удаляемый вместе с объектом
+	class TempFile {
+	public:
+		TempFile()
+				: file_(std::tmpfile()) {
+			if (file_ == nullptr) {
+				std::perror("tmpfile");
+				std::exit(1);
+			}
+		}
+		TempFile(const TempFile&) = delete;
+		TempFile& operator=(const TempFile&) = delete;
+		~TempFile() {
+			std::fclose(file_);
+		}
+		int Fd() const {
+			return fileno(file_);
+		}
+		// Очищает файл перед очередным прогоном записи
+		int Truncated() const {
+			if (ftruncate(Fd(), 0) != 0 || lseek(Fd(), 0, SEEK_SET) != 0) {
+				std::perror("ftruncate");
+				std::exit(1);
+			}
+			return Fd();
+		}
+		int Rewound() const {
+			lseek(Fd(), 0, SEEK_SET);
+			return Fd();
+		}
+
+	private:
+		FILE* file_;
+	};
+
+	void RunStreamingBenchmarks(BenchmarkRunner& runner) {
+		const size_t SIZE = 16 << 20;
+		const size_t CHUNK = 64 << 10;
+		TempFile file;
+		{
+			SimpleVector<char> data;
+			std::fill_n(data.AppendUninitialized(SIZE), SIZE, 'x');
+			WriteAll(file.Fd(), data);
+		}
+		runner.RunWithSetup("io/ReadAppend 64K chunks", SIZE, SIZE, [&] {
+			return file.Rewound();
+		}, [&](int fd) {
+			SimpleVector<char> buffer;
+			while (ReadAppend(buffer, fd, CHUNK) != 0) {
+			}
+			DoNotOptimize(buffer.begin());
+		});
+		runner.RunWithSetup("io/read + PushBack loop", SIZE, SIZE, [&] {
+			return file.Rewound();
+		}, [&](int fd) {
+			SimpleVector<char> buffer;
+			SimpleVector<char> chunk(CHUNK);
+			ssize_t received;
+			while ((received = read(fd, chunk.begin(), CHUNK)) > 0) {
+				for (ssize_t i = 0; i < received; ++i) {
+					buffer.PushBack(chunk[i]);
+				}
+			}
+			DoNotOptimize(buffer.begin());
+		});
+	}
+
+	void RunVectoredBenchmarks(BenchmarkRunner& runner) {
+		TempFile file;
+		for (const size_t count : {1'000, 10'000}) {
+			for (const size_t size : {16, 256, 4096}) {
+				SimpleVector<SimpleVector<char>> records(count);
+				for (auto& record : records) {
+					std::fill_n(record.AppendUninitialized(size), size, 'r');
+				}
+				const size_t bytes = count * size;
+				const std::string suffix = " " + std::to_string(count) + " x " + std::to_string(size) + "B";
+				runner.RunWithSetup("io/writev" + suffix, count, bytes, [&] {
+					return file.Truncated();
+				}, [&](int fd) {
+					WriteVectored(fd, records);
+				});
+				runner.RunWithSetup("io/write per record" + suffix, count, bytes, [&] {
+					return file.Truncated();
+				}, [&](int fd) {
+					for (const auto& record : records) {
+						WriteAll(fd, record);
+					}
+				});
+				runner.RunWithSetup("io/readv" + suffix, count, bytes, [&] {
+					SimpleVector<SimpleVector<char>> loaded(count);
+					for (auto& record : loaded) {
+						record.Reserve(size);
+					}
+					file.Rewound();
+					return loaded;
+				}, [&](SimpleVector<SimpleVector<char>>& loaded) {
+					ReadVectored(file.Fd(), loaded);
+				});
+			}
+		}
+	}
+
+	void RunAsyncBenchmarks(BenchmarkRunner& runner) {
+		const size_t SIZE = 4 << 20;
+		SimpleVector<uint64_t> data;
+		std::iota(data.AppendUninitialized(SIZE), data.end(), uint64_t{0});
+		const size_t bytes = SIZE * sizeof(uint64_t);
+		TempFile file;
+		const auto run = [&](const std::string& name, AsyncFileIo& io) {
+			runner.RunWithSetup(name, 1, bytes, [&] {
+				return file.Truncated();
+			}, [&](int fd) {
+				AsyncSave(io, fd, data, [](std::error_code error) {
+					if (error) {
+						std::cerr << "AsyncSave: " << error.message() << std::endl;
+					}
+				});
+				io.WaitAll();
+			});
+		};
+		AsyncFileIo sync(1, AsyncBackend::Sync);
+		run("io/AsyncSave 32MB pwrite", sync);
+		for (const unsigned depth : {1u, 4u, 16u, 64u}) {
+			AsyncFileIo io(depth);
+			const std::string backend = io.UsesUring() ? "io_uring" : "pwrite fallback";
+			run("io/AsyncSave 32MB " + backend + " depth " + std::to_string(depth), io);
+		}
+	}
+
+	void RunFrozenBenchmarks(BenchmarkRunner& runner) {
+		const size_t SIZE = 4 << 20;
+		std::mt19937 random(42);
+		SimpleVector<uint32_t> values;
+		for (size_t i = 0; i < SIZE; ++i) {
+			values.PushBack(random() % 100'000);
+		}
+		SimpleVector<uint32_t> sorted = values;
+		std::sort(sorted.begin(), sorted.end());
+		SimpleVector<size_t> lookups;
+		for (size_t i = 0; i < 100'000; ++i) {
+			lookups.PushBack(random() % SIZE);
+		}
+
+		for (const auto& [name, source] : {std::pair{"frame of reference"s, &values}, std::pair{"delta"s, &sorted}}) {
+			const auto frozen = Freeze(*source);
+			const double ratio = static_cast<double>(frozen.CompressedBytes()) / static_cast<double>(SIZE * sizeof(uint32_t));
+			const std::string note = "ratio " + std::to_string(ratio);
+			if (auto* result = runner.Run("frozen/Thaw " + name, SIZE, SIZE * sizeof(uint32_t), [&] {
+				DoNotOptimize(frozen.Thaw().begin());
+			})) {
+				result->note = note;
+			}
+			runner.Run("frozen/DecodeBlock " + name, SIZE, SIZE * sizeof(uint32_t), [&] {
+				uint32_t block[FrozenVector<uint32_t>::VALUES_PER_BLOCK];
+				for (size_t i = 0; i < frozen.BlockCount(); ++i) {
+					frozen.DecodeBlock(i, block);
+					DoNotOptimize(block);
+				}
+			});
+			runner.Run("frozen/point lookup " + name, lookups.Size(), 0, [&] {
+				uint64_t sum = 0;
+				for (const size_t index : lookups) {
+					sum += frozen[index];
+				}
+				DoNotOptimize(sum);
+			});
+		}
+	}
+
+	void RunEncodedBenchmarks(BenchmarkRunner& runner) {
+		std::mt19937 random(7);
+		const auto make_list = [&random](size_t size, uint32_t universe) {
+			SimpleVector<uint32_t> list;
+			for (size_t i = 0; i < size; ++i) {
+				list.PushBack(random() % universe);
+			}
+			std::sort(list.begin(), list.end());
+			return list;
+		};
+		for (const size_t small_size : {1'000, 100'000}) {
+			const auto large = make_list(1'000'000, 10'000'000);
+			const auto small = make_list(small_size, 10'000'000);
+			EncodedVector encoded_large;
+			EncodedVector encoded_small;
+			for (const uint32_t value : large) {
+				encoded_large.Append(value);
+			}
+			for (const uint32_t value : small) {
+				encoded_small.Append(value);
+			}
+			const std::string suffix = " 1M x " + std::to_string(small_size);
+			if (auto* result = runner.Run("encoded/Intersect" + suffix, small_size, 0, [&] {
+				DoNotOptimize(Intersect(encoded_large, encoded_small).begin());
+			})) {
+				result->note = "compressed " + std::to_string(encoded_large.CompressedBytes()) + " B vs "
+				               + std::to_string(large.Size() * sizeof(uint32_t)) + " B";
+			}
+			runner.Run("encoded/std::set_intersection" + suffix, small_size, 0, [&] {
+				SimpleVector<uint32_t> result;
+				uint32_t* first = result.AppendUninitialized(small.Size());
+				const uint32_t* last = std::set_intersection(large.begin(), large.end(), small.begin(), small.end(), first);
+				result.Resize(static_cast<size_t>(last - first));
+				DoNotOptimize(result.begin());
+			});
+		}
+		{
+			EncodedVector encoded;
+			for (uint32_t i = 0; i < 1'000'000; ++i) {
+				encoded.Append(i * 3);
+			}
+			runner.Run("encoded/Decode 1M", 1'000'000, 1'000'000 * sizeof(uint32_t), [&] {
+				DoNotOptimize(encoded.Decode().begin());
+			});
+		}
+	}
+
+	void RunDictBenchmarks(BenchmarkRunner& runner) {
+		const size_t SIZE = 1'000'000;
+		const size_t DISTINCT = 300;
+		std::mt19937 random(3);
+		SimpleVector<std::string> plain;
+		plain.Reserve(SIZE);
+		for (size_t i = 0; i < SIZE; ++i) {
+			plain.PushBack("category-" + std::to_string(random() % DISTINCT));
+		}
+		const DictVector<std::string> dict(plain);
+		const std::string needle = "category-17";
+		if (auto* result = runner.Run("dict/CountEqual DictVector", SIZE, 0, [&] {
+			DoNotOptimize(dict.CountEqual(needle));
+		})) {
+			result->note = "codes " + std::to_string(SIZE * dict.CodeWidth()) + " B vs strings "
+			               + std::to_string(SIZE * sizeof(std::string)) + " B";
+		}
+		runner.Run("dict/count plain SimpleVector<string>", SIZE, 0, [&] {
+			DoNotOptimize(std::count(plain.begin(), plain.end(), needle));
+		});
+	}
+
+	// 64-байтный элемент: при росте переносится в 16 раз больше байт на элемент, чем для int
+	struct Payload {
+		uint64_t words[8] = {};
+	};
+
+	// Задержка каждого PushBack в потоке из count добавлений в новый вектор. Рост из-за заполнения
+	// буфера переносит все элементы и даёт редкие длинные паузы, которые видны только в хвосте
+	template <typename T, typename Vector>
+	void MeasurePushBackLatency(LatencyHistogram& histogram, size_t count, bool reserve) {
+		Vector v;
+		if constexpr (std::is_same_v<Vector, SimpleVector<T>>) {
+			if (reserve) {
+				v.Reserve(count);
+			}
+		}
+		const T value{};
+		for (size_t i = 0; i < count; ++i) {
+			ScopedLatency latency(histogram);
+			v.PushBack(value);
+		}
+		DoNotOptimize(v[count - 1]);
+	}
+
+	template <typename T>
+	void RunLatencyBenchmarks(const BenchmarkRunner& runner, std::string_view type_name, size_t count, std::ostream& out) {
+		using Doubling = SimpleVector<T>;
+		using OneAndHalf = SimpleVector<T, DefaultVectorInstrumentation, FactorGrowth<3, 2>>;
+		using OneAndQuarter = SimpleVector<T, DefaultVectorInstrumentation, FactorGrowth<5, 4>>;
+		const size_t STREAMS = 3;
+		const auto run = [&](std::string_view policy, auto measure) {
+			const std::string name = "latency/PushBack<" + std::string(type_name) + "> " + std::string(policy);
+			if (!runner.IsEnabled(name)) {
+				return;
+			}
+			LatencyHistogram histogram;
+			measure(histogram);  // Прогрев
+			histogram.Reset();
+			for (size_t i = 0; i < STREAMS; ++i) {
+				measure(histogram);
+			}
+			out << std::left << std::setw(44) << name << std::right << std::setw(10) << histogram.ValueAtPercentile(50)
+			    << std::setw(10) << histogram.ValueAtPercentile(99) << std::setw(10) << histogram.ValueAtPercentile(99.9)
+			    << std::setw(12) << histogram.Max() << '\n';
+		};
+		run("x2", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, Doubling>(histogram, count, false);
+		});
+		run("x1.5", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, OneAndHalf>(histogram, count, false);
+		});
+		run("x1.25", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, OneAndQuarter>(histogram, count, false);
+		});
+		run("Reserve", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, Doubling>(histogram, count, true);
+		});
+		run("incremental x2", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, IncrementalVector<T>>(histogram, count, false);
+		});
+		run("prealloc x2", [count](LatencyHistogram& histogram) {
+			MeasurePushBackLatency<T, PreallocatingVector<T>>(histogram, count, false);
+		});
+	}
+
+	void RunLatencyBenchmarks(const BenchmarkRunner& runner, std::ostream& out) {
+		out << '\n' << std::left << std::setw(44) << "PushBack latency, ns" << std::right << std::setw(10) << "p50"
+		    << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << '\n';
+		RunLatencyBenchmarks<int>(runner, "int", 1 << 22, out);
+		RunLatencyBenchmarks<Payload>(runner, "Payload64", 1 << 19, out);
+	}
+
+	// Перемещение RawMemory забирает указатель, поэтому время не должно зависеть от ёмкости
+	void RunRawMemoryMoveBenchmarks(BenchmarkRunner& runner) {
+		const size_t MOVES = 1000;
+		for (const size_t capacity : {size_t{1} << 4, size_t{1} << 12, size_t{1} << 20}) {
+			runner.RunWithSetup("raw/move RawMemory<int>(" + std::to_string(capacity) + ")", 2 * MOVES, 0, [capacity] {
+				return RawMemory<int>(capacity);
+			}, [](RawMemory<int>& memory) {
+				RawMemory<int> other;
+				for (size_t i = 0; i < MOVES; ++i) {
+					other = std::move(memory);
+					memory = std::move(other);
+				}
+				DoNotOptimize(memory.GetAddress());
+			});
+		}
+	}
+
+	long MinorFaults() {
+		rusage usage{};
+		::getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_minflt;
+	}
+
+	// Page fault при резервировании и при заполнении зарезервированного буфера, по getrusage
+	void RunFaultBenchmark(const BenchmarkRunner& runner, ReserveMode mode, std::string_view mode_name, std::ostream& out) {
+		using Clock = std::chrono::steady_clock;
+		const size_t COUNT = size_t{1} << 24;
+		const std::string name = "faults/Reserve+PushBack<int> " + std::string(mode_name);
+		if (!runner.IsEnabled(name)) {
+			return;
+		}
+		SimpleVector<int> v;
+		const long before_reserve = MinorFaults();
+		const auto reserve_start = Clock::now();
+		v.Reserve(COUNT, mode);
+		const auto fill_start = Clock::now();
+		const long before_fill = MinorFaults();
+		for (size_t i = 0; i < COUNT; ++i) {
+			v.PushBack(static_cast<int>(i));
+		}
+		const auto fill_end = Clock::now();
+		const long after_fill = MinorFaults();
+		DoNotOptimize(v[COUNT - 1]);
+		const auto ms = [](Clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		};
+		out << std::left << std::setw(44) << name << std::right << std::setw(10) << before_fill - before_reserve
+		    << std::setw(10) << after_fill - before_fill << std::fixed << std::setprecision(2)
+		    << std::setw(12) << ms(fill_start - reserve_start) << std::setw(12) << ms(fill_end - fill_start) << '\n';
+	}
+
+	void RunFaultBenchmarks(const BenchmarkRunner& runner, std::ostream& out) {
+		out << '\n' << std::left << std::setw(44) << "Minor page faults and time, ms" << std::right << std::setw(10)
+		    << "reserve" << std::setw(10) << "fill" << std::setw(12) << "reserve ms" << std::setw(12) << "fill ms" << '\n';
+		RunFaultBenchmark(runner, ReserveMode::Lazy, "lazy", out);
+		RunFaultBenchmark(runner, ReserveMode::Prefault, "prefault", out);
+	}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+	BenchmarkOptions options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg.substr(0, 7) == "--runs="sv) {
+			options.runs = std::stoul(std::string(arg.substr(7)));
+		} else if (arg.substr(0, 9) == "--warmup="sv) {
+			options.warmup_runs = std::stoul(std::string(arg.substr(9)));
+		} else if (arg == "--perf"sv) {
+			options.perf_counters = true;
+		} else if (arg == "--help"sv) {
+			std::cout << "Usage: " << argv[0] << " [--runs=N] [--warmup=N] [--perf] [filter]\n";
+			return 0;
+		} else {
+			options.filter = std::string(arg);
+		}
+	}
+
+	BenchmarkRunner runner(options);
+	RunCoreBenchmarks<int>(runner);
+	RunCoreBenchmarks<std::string>(runner);
+	RunCoreBenchmarks<Obj>(runner);
+	RunCoreBenchmarks<TestObj>(runner);
+	RunStreamingBenchmarks(runner);
+	RunVectoredBenchmarks(runner);
+	RunAsyncBenchmarks(runner);
+	RunFrozenBenchmarks(runner);
+	RunEncodedBenchmarks(runner);
+	RunDictBenchmarks(runner);
+	RunRawMemoryMoveBenchmarks(runner);
+	runner.Report(std::cout);
+	RunLatencyBenchmarks(runner, std::cout);
+	RunFaultBenchmarks(runner, std::cout);
+}
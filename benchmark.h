@@ -0,0 +1,207 @@
+#pragma once
+#include "perf_counters.h"
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Не даёт компилятору выбросить вычисление value как неиспользуемое
+template <typename T>
+void DoNotOptimize(const T& value) noexcept {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Счётчик тактов процессора. На архитектурах без rdtsc всегда возвращает 0
+inline uint64_t ReadCycleCounter() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+struct BenchmarkOptions {
+	size_t warmup_runs = 3;
+	size_t runs = 31;
+	std::string filter;  // Запускаются только случаи, в имени которых есть эта подстрока
+	bool perf_counters = false;  // Собирать аппаратные счётчики perf_event_open
+};
+
+struct BenchmarkResult {
+	std::string name;
+	size_t ops_per_run = 0;
+	double median_ns_per_op = 0;
+	double p99_ns_per_op = 0;
+	double median_cycles_per_op = 0;
+	double bytes_per_second = 0;  // 0, если для случая не задан объём данных
+	PerfSample counters_per_op;  // Медианы счётчиков на операцию; недоступные помечены как невалидные
+	std::string note;
+};
+
+// Минимальный набор для микробенчмарков: каждый случай прогоняется warmup_runs раз вхолостую
+// и runs раз с замером. Для каждого прогона измеряются время и такты, в отчёт попадают медиана
+// и 99-й перцентиль в пересчёте на одну операцию
+class BenchmarkRunner {
+public:
+	explicit BenchmarkRunner(BenchmarkOptions options)
+			: options_(std::move(options))
+	{
+		options_.runs = std::max<size_t>(options_.runs, 1);
+		if (options_.perf_counters) {
+			counters_.emplace();
+		}
+	}
+
+	bool IsEnabled(std::string_view name) const noexcept {
+		return name.find(options_.filter) != std::string_view::npos;
+	}
+
+	// Замеряет body() — один прогон из ops_per_run операций над bytes_per_run байтами
+	template <typename Body>
+	BenchmarkResult* Run(std::string name, size_t ops_per_run, size_t bytes_per_run, Body body) {
+		return RunWithSetup(std::move(name), ops_per_run, bytes_per_run, [] {
+			return 0;
+		}, [&body](int) {
+			body();
+		});
+	}
+
+	// Перед каждым прогоном вызывает setup() вне замера и передаёт результат в body(state).
+	// Состояние уничтожается тоже вне замера. Возвращает результат, чтобы к нему можно было
+	// добавить примечание, или nullptr, если случай отфильтрован. Указатель действителен до следующего Run
+	template <typename Setup, typename Body>
+	BenchmarkResult* RunWithSetup(std::string name, size_t ops_per_run, size_t bytes_per_run, Setup setup, Body body) {
+		if (!IsEnabled(name)) {
+			return nullptr;
+		}
+		for (size_t i = 0; i < options_.warmup_runs; ++i) {
+			auto state = setup();
+			body(state);
+		}
+		SimpleVector<Sample> samples;
+		samples.Reserve(options_.runs);
+		for (size_t i = 0; i < options_.runs; ++i) {
+			auto state = setup();
+			// Счётчики запускаются снаружи замера времени, чтобы ioctl не попадал в него
+			if (counters_) {
+				counters_->Start();
+			}
+			const auto start = Clock::now();
+			const uint64_t start_cycles = ReadCycleCounter();
+			body(state);
+			const uint64_t cycles = ReadCycleCounter() - start_cycles;
+			const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			const PerfSample counters = counters_ ? counters_->Stop() : PerfSample{};
+			samples.PushBack({elapsed, static_cast<double>(cycles), counters});
+		}
+
+		BenchmarkResult result;
+		result.name = std::move(name);
+		result.ops_per_run = ops_per_run;
+		const double ops = static_cast<double>(std::max<size_t>(ops_per_run, 1));
+		const auto ns = [](const Sample& sample) {
+			return sample.ns;
+		};
+		const double median_ns = Percentile(samples, 0.5, ns);
+		result.median_ns_per_op = median_ns / ops;
+		result.p99_ns_per_op = Percentile(samples, 0.99, ns) / ops;
+		result.median_cycles_per_op = Percentile(samples, 0.5, [](const Sample& sample) {
+			return sample.cycles;
+		}) / ops;
+		for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+			// Счётчик попадает в отчёт, только если его удалось прочитать во всех прогонах
+			const bool valid = std::all_of(samples.begin(), samples.end(), [i](const Sample& sample) {
+				return sample.counters.valid[i];
+			});
+			if (valid) {
+				result.counters_per_op.valid[i] = true;
+				result.counters_per_op.values[i] = Percentile(samples, 0.5, [i](const Sample& sample) {
+					return sample.counters.values[i];
+				}) / ops;
+			}
+		}
+		if (bytes_per_run != 0 && median_ns > 0) {
+			result.bytes_per_second = static_cast<double>(bytes_per_run) / median_ns * 1e9;
+		}
+		results_.PushBack(std::move(result));
+		return &results_[results_.Size() - 1];
+	}
+
+	const SimpleVector<BenchmarkResult>& Results() const noexcept {
+		return results_;
+	}
+
+	void Report(std::ostream& out) const {
+		const auto flags = out.flags();
+		if (counters_ && !counters_->Error().empty()) {
+			out << "# some perf counters are unavailable (" << counters_->Error() << "), shown as -\n";
+		}
+		out << std::left << std::setw(NAME_WIDTH) << "benchmark" << std::right
+		    << std::setw(12) << "ns/op" << std::setw(12) << "p99 ns/op" << std::setw(12) << "cycles/op"
+		    << std::setw(12) << "MB/s";
+		if (counters_) {
+			for (const std::string_view name : PERF_COUNTER_NAMES) {
+				out << std::setw(COUNTER_WIDTH) << name;
+			}
+		}
+		out << "  note\n";
+		for (const BenchmarkResult& result : results_) {
+			out << std::left << std::setw(NAME_WIDTH) << result.name << std::right << std::fixed << std::setprecision(2)
+			    << std::setw(12) << result.median_ns_per_op << std::setw(12) << result.p99_ns_per_op
+			    << std::setw(12) << result.median_cycles_per_op << std::setw(12);
+			if (result.bytes_per_second != 0) {
+				out << result.bytes_per_second / 1e6;
+			} else {
+				out << "-";
+			}
+			if (counters_) {
+				for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+					out << std::setw(COUNTER_WIDTH);
+					if (result.counters_per_op.valid[i]) {
+						out << result.counters_per_op.values[i];
+					} else {
+						out << "-";
+					}
+				}
+			}
+			out << "  " << result.note << '\n';
+		}
+		out.flags(flags);
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr int NAME_WIDTH = 56;
+	static constexpr int COUNTER_WIDTH = 15;
+
+	struct Sample {
+		double ns;
+		double cycles;
+		PerfSample counters;
+	};
+
+	template <typename Key>
+	static double Percentile(SimpleVector<Sample>& samples, double fraction, Key key) {
+		std::sort(samples.begin(), samples.end(), [&key](const Sample& lhs, const Sample& rhs) {
+			return key(lhs) < key(rhs);
+		});
+		const auto index = static_cast<size_t>(fraction * static_cast<double>(samples.Size() - 1) + 0.5);
+		return key(samples[index]);
+	}
+
+	BenchmarkOptions options_;
+	std::optional<PerfCounters> counters_;
+	SimpleVector<BenchmarkResult> results_;
+};
@@ -0,0 +1,234 @@
+#pragma once
+#include "serialization.h"
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+// Заголовок записи журнала изменений. За ним следуют range_count пар (начало, длина) в элементах
+// и затем содержимое этих диапазонов подряд
+struct VectorDeltaHeader {
+	static constexpr char MAGIC[4] = {'S', 'V', 'D', 'L'};
+
+	char magic[4];
+	uint32_t element_size;
+	uint64_t size;
+	uint64_t range_count;
+	uint64_t checksum;
+};
+
+static_assert(sizeof(VectorDeltaHeader) == 32);
+
+struct VectorDeltaRange {
+	uint64_t first;
+	uint64_t count;
+};
+
+inline uint64_t CombineChecksums(uint64_t seed, uint64_t value) noexcept {
+	return (seed ^ value) * 0x100000001b3ULL + (seed >> 17);
+}
+
+// Контрольная сумма записи журнала до её содержимого: размер вектора и список диапазонов
+inline uint64_t ComputeDeltaChecksum(uint64_t size, const SimpleVector<VectorDeltaRange>& ranges) noexcept {
+	return CombineChecksums(ComputeChecksum(ranges.begin(), ranges.Size() * sizeof(VectorDeltaRange)), size);
+}
+
+// Инкрементальные контрольные точки вектора, который в основном растёт в конец.
+// Первая точка (WriteBase) сохраняет вектор целиком в формате Save, следующие (WriteDelta) дописывают
+// в журнал только элементы от наименьшего размера после предыдущей точки и диапазоны, отмеченные
+// через MarkDirty. Изменения не отслеживаются автоматически: каждый изменённый через operator[]
+// элемент ниже отметки HighWaterMark() нужно отметить вызовом MarkDirty, а каждое уменьшение
+// размера (PopBack, Resize, Erase) — вызовом NoteShrink с новым размером или позицией удаления
+template <typename T>
+class VectorCheckpointer {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be checkpointed");
+
+public:
+	explicit VectorCheckpointer(const SimpleVector<T>& vector) noexcept
+			: vector_(&vector) {
+	}
+
+	// Размер вектора на момент последней контрольной точки
+	size_t HighWaterMark() const noexcept {
+		return high_water_mark_;
+	}
+
+	// Наименьший размер вектора после последней контрольной точки: элементы начиная с него
+	// попадут в следующую дельту целиком
+	size_t LowWaterMark() const noexcept {
+		return low_water_mark_;
+	}
+
+	// Отмечает, что элементы начиная с new_size удалялись, и их содержимое могло смениться
+	void NoteShrink(size_t new_size) noexcept {
+		low_water_mark_ = std::min(low_water_mark_, new_size);
+	}
+
+	void MarkDirty(size_t first, size_t count = 1) {
+		if (first < high_water_mark_ && count != 0) {
+			dirty_.PushBack({first, std::min(count, high_water_mark_ - first)});
+		}
+	}
+
+	void WriteBase(std::ostream& out) {
+		Save(out, *vector_);
+		Reset();
+	}
+
+	// Дописывает в журнал одну запись с изменениями, накопленными после предыдущей точки
+	void WriteDelta(std::ostream& out) {
+		const SimpleVector<VectorDeltaRange> ranges = CollectRanges();
+		uint64_t checksum = ComputeDeltaChecksum(vector_->Size(), ranges);
+		for (const VectorDeltaRange& range : ranges) {
+			checksum = CombineChecksums(checksum, ComputeChecksum(&(*vector_)[range.first], range.count * sizeof(T)));
+		}
+
+		VectorDeltaHeader header{};
+		std::memcpy(header.magic, VectorDeltaHeader::MAGIC, sizeof(header.magic));
+		header.element_size = sizeof(T);
+		header.size = vector_->Size();
+		header.range_count = ranges.Size();
+		header.checksum = checksum;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(ranges.begin()),
+		          static_cast<std::streamsize>(ranges.Size() * sizeof(VectorDeltaRange)));
+		for (const VectorDeltaRange& range : ranges) {
+			out.write(reinterpret_cast<const char*>(&(*vector_)[range.first]),
+			          static_cast<std::streamsize>(range.count * sizeof(T)));
+		}
+		if (!out) {
+			throw SerializationError("Failed to write SimpleVector checkpoint");
+		}
+		Reset();
+	}
+
+private:
+	// Упорядочивает и сливает отмеченные диапазоны, добавляя к ним хвост за отметкой отлива
+	SimpleVector<VectorDeltaRange> CollectRanges() {
+		const size_t size = vector_->Size();
+		// Уменьшение, не отмеченное через NoteShrink, заметно хотя бы по текущему размеру
+		const size_t low_water_mark = std::min(low_water_mark_, size);
+		std::sort(dirty_.begin(), dirty_.end(), [](const VectorDeltaRange& lhs, const VectorDeltaRange& rhs) {
+			return lhs.first < rhs.first;
+		});
+		SimpleVector<VectorDeltaRange> ranges;
+		for (const VectorDeltaRange& range : dirty_) {
+			if (range.first >= low_water_mark) {
+				break;
+			}
+			const uint64_t last = std::min<uint64_t>(range.first + range.count, low_water_mark);
+			if (ranges.Size() != 0 && range.first <= ranges[ranges.Size() - 1].first + ranges[ranges.Size() - 1].count) {
+				VectorDeltaRange& previous = ranges[ranges.Size() - 1];
+				previous.count = std::max(previous.count, last - previous.first);
+			} else {
+				ranges.PushBack({range.first, last - range.first});
+			}
+		}
+		if (size > low_water_mark) {
+			if (ranges.Size() != 0 && ranges[ranges.Size() - 1].first + ranges[ranges.Size() - 1].count == low_water_mark) {
+				ranges[ranges.Size() - 1].count += size - low_water_mark;
+			} else {
+				ranges.PushBack({low_water_mark, size - low_water_mark});
+			}
+		}
+		return ranges;
+	}
+
+	void Reset() {
+		high_water_mark_ = low_water_mark_ = vector_->Size();
+		SimpleVector<VectorDeltaRange> empty;
+		dirty_.Swap(empty);
+	}
+
+	const SimpleVector<T>* vector_;
+	size_t high_water_mark_ = 0;
+	size_t low_water_mark_ = 0;
+	SimpleVector<VectorDeltaRange> dirty_;
+};
+
+namespace detail {
+
+	// Дописывает в out count элементов из потока, уменьшая remaining на прочитанное. Возвращает false,
+	// если поток кончился раньше. Буфер не выделяется сверх оставшейся длины потока, а если она
+	// неизвестна (remaining < 0), растёт частями по LOAD_CHUNK_BYTES
+	template <typename U>
+	bool ReadDeltaElements(std::istream& in, SimpleVector<U>& out, uint64_t count, std::streamoff& remaining) {
+		if (remaining >= 0) {
+			if (count > static_cast<uint64_t>(remaining) / sizeof(U)) {
+				return false;
+			}
+			remaining -= static_cast<std::streamoff>(count * sizeof(U));
+		}
+		const size_t chunk = remaining >= 0 ? static_cast<size_t>(count)
+		                                    : std::max<size_t>(1, LOAD_CHUNK_BYTES / sizeof(U));
+		while (count != 0) {
+			const size_t part = static_cast<size_t>(std::min<uint64_t>(chunk, count));
+			U* data = out.AppendUninitialized(part);
+			if (!in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(part * sizeof(U)))) {
+				return false;
+			}
+			count -= part;
+		}
+		return true;
+	}
+
+}  // namespace detail
+
+// Восстанавливает вектор из полного снимка и журнала изменений. Запись журнала, оборванная
+// на середине (например, при падении во время записи), и всё, что за ней, игнорируются
+template <typename T>
+SimpleVector<T> Recover(std::istream& base, std::istream& deltas) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be checkpointed");
+	SimpleVector<T> result = Load<T>(base);
+	VectorDeltaHeader header;
+	while (deltas.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		if (std::memcmp(header.magic, VectorDeltaHeader::MAGIC, sizeof(header.magic)) != 0
+		    || header.element_size != sizeof(T)) {
+			throw SerializationError("Not a SimpleVector checkpoint");
+		}
+		std::streamoff remaining = detail::RemainingBytes(deltas);
+		SimpleVector<VectorDeltaRange> ranges;
+		if (!detail::ReadDeltaElements(deltas, ranges, header.range_count, remaining)) {
+			break;
+		}
+		// Изменения читаются во временный буфер, чтобы не применять оборванную запись частично
+		SimpleVector<T> values;
+		uint64_t checksum = ComputeDeltaChecksum(header.size, ranges);
+		bool is_complete = true;
+		for (const VectorDeltaRange& range : ranges) {
+			if (range.first > header.size || range.count > header.size - range.first) {
+				throw SerializationError("SimpleVector checkpoint range is out of bounds");
+			}
+			const size_t offset = values.Size();
+			if (!detail::ReadDeltaElements(deltas, values, range.count, remaining)) {
+				is_complete = false;
+				break;
+			}
+			checksum = CombineChecksums(checksum, ComputeChecksum(values.begin() + offset, range.count * sizeof(T)));
+		}
+		if (!is_complete) {
+			break;
+		}
+		if (checksum != header.checksum) {
+			throw SerializationError("SimpleVector checkpoint checksum mismatch");
+		}
+
+		const auto size = static_cast<size_t>(header.size);
+		if (size > result.Size()) {
+			result.AppendUninitialized(size - result.Size());
+		} else {
+			result.Resize(size);
+		}
+		const T* value = values.begin();
+		for (const VectorDeltaRange& range : ranges) {
+			std::copy_n(value, range.count, &result[range.first]);
+			value += range.count;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "simple_vector.h"
+#include "vector_view.h"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+
+// Вектор со словарным кодированием для столбцов с небольшим числом различных значений.
+// Каждое различное значение хранится один раз в словаре, а строки — узкими кодами
+// (uint8_t, uint16_t или uint32_t). Ширина кода выбирается по размеру словаря и расширяется
+// при его росте. Поиск по равенству сравнивает коды, не обращаясь к самим значениям
+template <typename T, typename Hash = std::hash<T>>
+class DictVector {
+public:
+	DictVector() = default;
+
+	explicit DictVector(VectorView<T> values) {
+		for (const T& value : values) {
+			PushBack(value);
+		}
+	}
+
+	size_t Size() const noexcept {
+		return std::visit([](const auto& codes) {
+			return codes.Size();
+		}, codes_);
+	}
+
+	size_t DictionarySize() const noexcept {
+		return dictionary_.Size();
+	}
+
+	// Ширина одного кода в байтах
+	size_t CodeWidth() const noexcept {
+		return std::visit([](const auto& codes) {
+			return sizeof(*codes.begin());
+		}, codes_);
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		assert(index < Size());
+		return dictionary_[CodeAt(index)];
+	}
+
+	void PushBack(const T& value) {
+		const uint32_t code = GetOrAddCode(value);
+		std::visit([code](auto& codes) {
+			using Code = std::remove_reference_t<decltype(*codes.begin())>;
+			codes.PushBack(static_cast<Code>(code));
+		}, codes_);
+	}
+
+	// Число строк, равных value
+	size_t CountEqual(const T& value) const {
+		const auto it = code_by_value_.find(value);
+		if (it == code_by_value_.end()) {
+			return 0;
+		}
+		return std::visit([code = it->second](const auto& codes) {
+			size_t count = 0;
+			for (const auto c : codes) {
+				count += c == code;
+			}
+			return count;
+		}, codes_);
+	}
+
+	// Номера строк, равных value, по возрастанию
+	SimpleVector<size_t> FindEqual(const T& value) const {
+		SimpleVector<size_t> result;
+		const auto it = code_by_value_.find(value);
+		if (it == code_by_value_.end()) {
+			return result;
+		}
+		std::visit([code = it->second, &result](const auto& codes) {
+			for (size_t i = 0; i < codes.Size(); ++i) {
+				if (codes[i] == code) {
+					result.PushBack(i);
+				}
+			}
+		}, codes_);
+		return result;
+	}
+
+	SimpleVector<T> Decode() const {
+		SimpleVector<T> result;
+		result.Reserve(Size());
+		for (size_t i = 0; i < Size(); ++i) {
+			result.PushBack((*this)[i]);
+		}
+		return result;
+	}
+
+private:
+	using Codes = std::variant<SimpleVector<uint8_t>, SimpleVector<uint16_t>, SimpleVector<uint32_t>>;
+
+	uint32_t CodeAt(size_t index) const noexcept {
+		return std::visit([index](const auto& codes) {
+			return static_cast<uint32_t>(codes[index]);
+		}, codes_);
+	}
+
+	uint32_t GetOrAddCode(const T& value) {
+		if (const auto it = code_by_value_.find(value); it != code_by_value_.end()) {
+			return it->second;
+		}
+		const auto code = static_cast<uint32_t>(dictionary_.Size());
+		if (code == std::numeric_limits<uint8_t>::max() + 1u) {
+			Widen<uint8_t, uint16_t>();
+		} else if (code == std::numeric_limits<uint16_t>::max() + 1u) {
+			Widen<uint16_t, uint32_t>();
+		}
+		dictionary_.PushBack(value);
+		code_by_value_.emplace(value, code);
+		return code;
+	}
+
+	// Перекодирует строки в более широкий тип кода
+	template <typename From, typename To>
+	void Widen() {
+		const auto& narrow = std::get<SimpleVector<From>>(codes_);
+		SimpleVector<To> wide;
+		To* out = wide.AppendUninitialized(narrow.Size());
+		for (const From code : narrow) {
+			*out++ = code;
+		}
+		codes_ = std::move(wide);
+	}
+
+	SimpleVector<T> dictionary_;
+	std::unordered_map<T, uint32_t, Hash> code_by_value_;
+	Codes codes_;
+};
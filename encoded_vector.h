@@ -0,0 +1,306 @@
+#pragma once
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+// Векторная распаковка компилируется для x86 независимо от флагов сборки и выбирается при запуске,
+// если процессор поддерживает SSSE3
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLE_VECTOR_HAS_SSSE3_DECODE 1
+#include <tmmintrin.h>
+#endif
+
+namespace detail {
+
+	// Длина в байтах (1..4) каждого из четырёх значений группы, закодированная в управляющем байте
+	constexpr size_t StreamVByteLength(uint8_t control, size_t index) noexcept {
+		return ((control >> (2 * index)) & 3) + 1;
+	}
+
+	struct StreamVByteTables {
+		std::array<uint8_t, 256> group_length{};
+		std::array<std::array<uint8_t, 16>, 256> shuffle{};
+	};
+
+	// Для каждого управляющего байта: суммарная длина группы и маска pshufb, раскладывающая
+	// байты значений по 32-битным позициям (0x80 обнуляет старшие байты)
+	constexpr StreamVByteTables MakeStreamVByteTables() noexcept {
+		StreamVByteTables tables{};
+		for (size_t control = 0; control < 256; ++control) {
+			uint8_t source = 0;
+			for (size_t value = 0; value < 4; ++value) {
+				const size_t length = StreamVByteLength(static_cast<uint8_t>(control), value);
+				for (size_t byte = 0; byte < 4; ++byte) {
+					tables.shuffle[control][value * 4 + byte] = byte < length ? source++ : 0x80;
+				}
+			}
+			tables.group_length[control] = source;
+		}
+		return tables;
+	}
+
+	inline constexpr StreamVByteTables STREAM_VBYTE_TABLES = MakeStreamVByteTables();
+
+	// Распаковывает четыре разности группы и возвращает указатель на данные следующей группы
+	inline const uint8_t* DecodeStreamVByteGroupScalar(uint8_t control, const uint8_t* data, uint32_t* out) noexcept {
+		const uint8_t* source = data;
+		for (size_t value = 0; value < 4; ++value) {
+			const size_t length = StreamVByteLength(control, value);
+			uint32_t delta = 0;
+			for (size_t byte = 0; byte < length; ++byte) {
+				delta |= static_cast<uint32_t>(source[byte]) << (8 * byte);
+			}
+			out[value] = delta;
+			source += length;
+		}
+		return data + STREAM_VBYTE_TABLES.group_length[control];
+	}
+
+#if defined(SIMPLE_VECTOR_HAS_SSSE3_DECODE)
+	// То же одной инструкцией pshufb. Читает 16 байт начиная с data
+	__attribute__((target("ssse3")))
+	inline const uint8_t* DecodeStreamVByteGroupSsse3(uint8_t control, const uint8_t* data, uint32_t* out) noexcept {
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(STREAM_VBYTE_TABLES.shuffle[control].data()));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(bytes, mask));
+		return data + STREAM_VBYTE_TABLES.group_length[control];
+	}
+
+	__attribute__((target("ssse3")))
+	inline const uint8_t* DecodeStreamVByteGroupsSsse3(const uint8_t* control, size_t groups, const uint8_t* data,
+	                                                   uint32_t* out) noexcept {
+		for (size_t group = 0; group < groups; ++group) {
+			data = DecodeStreamVByteGroupSsse3(control[group], data, out + group * 4);
+		}
+		return data;
+	}
+#endif
+
+	// Поддерживает ли процессор векторную распаковку. Проверяется один раз
+	inline bool HasSsse3Decode() noexcept {
+#if defined(SIMPLE_VECTOR_HAS_SSSE3_DECODE)
+		static const bool supported = __builtin_cpu_supports("ssse3");
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+}  // namespace detail
+
+// Сжатый список неубывающих 32-битных идентификаторов (например, список вхождений), в который можно
+// только дописывать. Разности соседних значений хранятся блоками по VALUES_PER_BLOCK в формате
+// stream-vbyte: сначала управляющие байты с длинами, затем байты самих разностей.
+// Для каждого блока есть указатель пропуска (последнее значение и смещение), что позволяет
+// искать значение, распаковывая единственный блок. Незаполненный последний блок хранится как есть.
+// На процессорах с SSSE3 группа из четырёх разностей распаковывается одной инструкцией pshufb
+class EncodedVector {
+public:
+	static constexpr size_t VALUES_PER_BLOCK = 128;
+
+	// Используется ли векторная распаковка на этом процессоре
+	static bool IsVectorized() noexcept {
+		return detail::HasSsse3Decode();
+	}
+
+	class Reader;
+
+	size_t Size() const noexcept {
+		return blocks_.Size() * VALUES_PER_BLOCK + tail_.Size();
+	}
+
+	size_t BlockCount() const noexcept {
+		return blocks_.Size() + (tail_.Size() != 0 ? 1 : 0);
+	}
+
+	// Объём сжатых данных в байтах, включая указатели пропуска и несжатый хвост
+	size_t CompressedBytes() const noexcept {
+		return bytes_.Size() + blocks_.Size() * sizeof(SkipEntry) + tail_.Size() * sizeof(uint32_t);
+	}
+
+	void Append(uint32_t value) {
+		assert(Size() == 0 || value >= last_);
+		tail_.PushBack(value);
+		last_ = value;
+		if (tail_.Size() == VALUES_PER_BLOCK) {
+			EncodeTail();
+		}
+	}
+
+	// Распаковывает блок block_index в scratch, заменяя его содержимое
+	void DecodeBlock(size_t block_index, SimpleVector<uint32_t>& scratch) const {
+		assert(block_index < BlockCount());
+		scratch.Resize(0);
+		if (block_index == blocks_.Size()) {
+			std::copy(tail_.begin(), tail_.end(), scratch.AppendUninitialized(tail_.Size()));
+		} else {
+			DecodeBlock(block_index, scratch.AppendUninitialized(VALUES_PER_BLOCK));
+		}
+	}
+
+	SimpleVector<uint32_t> Decode() const {
+		SimpleVector<uint32_t> result;
+		uint32_t* out = result.AppendUninitialized(Size());
+		for (size_t i = 0; i < blocks_.Size(); ++i) {
+			DecodeBlock(i, out + i * VALUES_PER_BLOCK);
+		}
+		std::copy(tail_.begin(), tail_.end(), out + blocks_.Size() * VALUES_PER_BLOCK);
+		return result;
+	}
+
+private:
+	struct SkipEntry {
+		uint32_t base;  // Значение перед блоком: первая разность блока отсчитывается от него
+		uint32_t last;  // Последнее значение блока
+		size_t offset;  // Смещение блока в bytes_
+	};
+
+	static constexpr size_t CONTROL_BYTES = VALUES_PER_BLOCK / 4;
+	// Векторная распаковка читает по 16 байт, поэтому за последним блоком держится запас нулей
+	static constexpr size_t PADDING = 16;
+
+	void EncodeTail() {
+		const uint32_t base = blocks_.Size() == 0 ? 0 : blocks_[blocks_.Size() - 1].last;
+		const size_t offset = bytes_.Size() == 0 ? 0 : bytes_.Size() - PADDING;
+		bytes_.Resize(offset);
+		uint8_t* control = bytes_.AppendUninitialized(CONTROL_BYTES);
+		std::fill_n(control, CONTROL_BYTES, uint8_t{0});
+		uint32_t previous = base;
+		for (size_t i = 0; i < VALUES_PER_BLOCK; ++i) {
+			const uint32_t delta = tail_[i] - previous;
+			previous = tail_[i];
+			const size_t length = delta < (1u << 8) ? 1 : delta < (1u << 16) ? 2 : delta < (1u << 24) ? 3 : 4;
+			// Хвост буфера может переехать при росте, поэтому управляющий байт адресуется по смещению
+			bytes_[offset + i / 4] |= static_cast<uint8_t>((length - 1) << (2 * (i % 4)));
+			uint8_t* data = bytes_.AppendUninitialized(length);
+			for (size_t byte = 0; byte < length; ++byte) {
+				data[byte] = static_cast<uint8_t>(delta >> (8 * byte));
+			}
+		}
+		std::fill_n(bytes_.AppendUninitialized(PADDING), PADDING, uint8_t{0});
+		blocks_.PushBack({base, tail_[VALUES_PER_BLOCK - 1], offset});
+		tail_.Resize(0);
+	}
+
+	void DecodeBlock(size_t block_index, uint32_t* out) const noexcept {
+		const SkipEntry& entry = blocks_[block_index];
+		const uint8_t* control = bytes_.begin() + entry.offset;
+		const uint8_t* data = control + CONTROL_BYTES;
+#if defined(SIMPLE_VECTOR_HAS_SSSE3_DECODE)
+		if (detail::HasSsse3Decode()) {
+			detail::DecodeStreamVByteGroupsSsse3(control, CONTROL_BYTES, data, out);
+		} else
+#endif
+		{
+			for (size_t group = 0; group < CONTROL_BYTES; ++group) {
+				data = detail::DecodeStreamVByteGroupScalar(control[group], data, out + group * 4);
+			}
+		}
+		uint32_t previous = entry.base;
+		for (size_t i = 0; i < VALUES_PER_BLOCK; ++i) {
+			previous += out[i];
+			out[i] = previous;
+		}
+	}
+
+	SimpleVector<uint8_t> bytes_;
+	SimpleVector<SkipEntry> blocks_;
+	SimpleVector<uint32_t> tail_;
+	uint32_t last_ = 0;
+};
+
+// Последовательное чтение с поиском вперёд. Хранит распакованным только текущий блок
+class EncodedVector::Reader {
+public:
+	explicit Reader(const EncodedVector& vector)
+			: vector_(&vector)
+	{
+		LoadBlock(0);
+	}
+
+	bool IsEnd() const noexcept {
+		return block_ >= vector_->BlockCount();
+	}
+
+	uint32_t Value() const noexcept {
+		assert(!IsEnd());
+		return scratch_[position_];
+	}
+
+	void Next() {
+		assert(!IsEnd());
+		if (++position_ == scratch_.Size()) {
+			LoadBlock(block_ + 1);
+		}
+	}
+
+	// Переходит к первому значению не меньше target, не возвращаясь назад. Блоки, последнее
+	// значение которых меньше target, пропускаются по указателям без распаковки.
+	// Возвращает false, если такого значения нет
+	bool SeekTo(uint32_t target) {
+		if (IsEnd()) {
+			return false;
+		}
+		if (scratch_.Size() == 0 || scratch_[scratch_.Size() - 1] < target) {
+			const auto& blocks = vector_->blocks_;
+			const auto first = blocks.begin() + std::min(block_, blocks.Size());
+			const auto skip = std::partition_point(first, blocks.end(), [target](const SkipEntry& entry) {
+				return entry.last < target;
+			});
+			LoadBlock(static_cast<size_t>(skip - blocks.begin()));
+			if (IsEnd()) {
+				return false;
+			}
+		}
+		position_ = static_cast<size_t>(std::lower_bound(scratch_.begin() + position_, scratch_.end(), target)
+		                                - scratch_.begin());
+		if (position_ == scratch_.Size()) {
+			// Значения нет даже в несжатом хвосте
+			LoadBlock(vector_->BlockCount());
+			return false;
+		}
+		return true;
+	}
+
+private:
+	void LoadBlock(size_t block) {
+		block_ = block;
+		position_ = 0;
+		if (IsEnd()) {
+			scratch_.Resize(0);
+		} else {
+			vector_->DecodeBlock(block_, scratch_);
+		}
+	}
+
+	const EncodedVector* vector_;
+	size_t block_ = 0;
+	size_t position_ = 0;
+	SimpleVector<uint32_t> scratch_;
+};
+
+// Пересечение двух списков. Идёт по более короткому списку и ищет его значения в длинном,
+// пропуская блоки длинного списка по указателям
+inline SimpleVector<uint32_t> Intersect(const EncodedVector& lhs, const EncodedVector& rhs) {
+	const EncodedVector& shorter = lhs.Size() <= rhs.Size() ? lhs : rhs;
+	const EncodedVector& longer = lhs.Size() <= rhs.Size() ? rhs : lhs;
+	SimpleVector<uint32_t> result;
+	EncodedVector::Reader probe(longer);
+	SimpleVector<uint32_t> scratch;
+	for (size_t block = 0; block < shorter.BlockCount(); ++block) {
+		shorter.DecodeBlock(block, scratch);
+		for (const uint32_t value : scratch) {
+			if (!probe.SeekTo(value)) {
+				return result;
+			}
+			if (probe.Value() == value && (result.Size() == 0 || result[result.Size() - 1] != value)) {
+				result.PushBack(value);
+			}
+		}
+	}
+	return result;
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include "simple_vector.h"
+#include "vector_view.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Неизменяемое сжатое представление вектора целых чисел для редко используемых данных.
+// Значения разбиты на блоки по VALUES_PER_BLOCK. В каждом блоке хранится опорное значение и ширина
+// в битах, а сами значения упакованы подряд в 64-битные слова:
+//  - для произвольных данных — смещения от минимума блока (frame of reference);
+//  - для неубывающих данных — разности соседних значений (delta), что обычно даёт меньшую ширину.
+// Доступ по индексу распаковывает одно значение (или префикс блока для delta), DecodeBlock
+// распаковывает блок целиком специализированным под ширину циклом без ветвлений
+template <typename T>
+class FrozenVector {
+	static_assert(std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t>,
+	              "FrozenVector supports uint32_t and uint64_t only");
+
+public:
+	static constexpr size_t VALUES_PER_BLOCK = 128;
+
+	enum class Encoding {
+		FrameOfReference,
+		Delta,
+	};
+
+	FrozenVector() noexcept = default;
+
+	// Сжимает значения, выбирая delta-кодирование для неубывающих данных
+	static FrozenVector Freeze(VectorView<T> values) {
+		FrozenVector result;
+		result.size_ = values.Size();
+		result.encoding_ = std::is_sorted(values.begin(), values.end()) ? Encoding::Delta : Encoding::FrameOfReference;
+		std::array<T, VALUES_PER_BLOCK> offsets{};
+		for (size_t first = 0; first < values.Size(); first += VALUES_PER_BLOCK) {
+			const size_t count = std::min(VALUES_PER_BLOCK, values.Size() - first);
+			Block block;
+			T max_offset = 0;
+			if (result.encoding_ == Encoding::Delta) {
+				block.base = values[first];
+				T previous = block.base;
+				for (size_t i = 0; i < count; ++i) {
+					offsets[i] = values[first + i] - previous;
+					previous = values[first + i];
+					max_offset = std::max(max_offset, offsets[i]);
+				}
+			} else {
+				block.base = *std::min_element(values.begin() + first, values.begin() + first + count);
+				for (size_t i = 0; i < count; ++i) {
+					offsets[i] = values[first + i] - block.base;
+					max_offset = std::max(max_offset, offsets[i]);
+				}
+			}
+			std::fill(offsets.begin() + count, offsets.end(), T{0});
+			block.width = BitWidth(max_offset);
+			block.word_offset = result.words_.Size();
+			// Блок из 128 значений шириной w занимает ровно 2 * w слов
+			uint64_t* words = result.words_.AppendUninitialized(2 * block.width);
+			Pack(offsets.data(), block.width, words);
+			result.blocks_.PushBack(block);
+		}
+		return result;
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	Encoding GetEncoding() const noexcept {
+		return encoding_;
+	}
+
+	// Объём сжатого представления в байтах
+	size_t CompressedBytes() const noexcept {
+		return words_.Size() * sizeof(uint64_t) + blocks_.Size() * sizeof(Block);
+	}
+
+	T operator[](size_t index) const noexcept {
+		assert(index < size_);
+		const Block& block = blocks_[index / VALUES_PER_BLOCK];
+		const uint64_t* words = words_.begin() + block.word_offset;
+		const size_t position = index % VALUES_PER_BLOCK;
+		if (encoding_ == Encoding::FrameOfReference) {
+			return block.base + static_cast<T>(Extract(words, block.width, position));
+		}
+		T value = block.base;
+		for (size_t i = 1; i <= position; ++i) {
+			value += static_cast<T>(Extract(words, block.width, i));
+		}
+		return value;
+	}
+
+	size_t BlockCount() const noexcept {
+		return blocks_.Size();
+	}
+
+	// Распаковывает блок block_index в out, где должно быть место под VALUES_PER_BLOCK значений.
+	// Возвращает число значений в блоке (у последнего блока оно может быть меньше VALUES_PER_BLOCK)
+	size_t DecodeBlock(size_t block_index, T* out) const noexcept {
+		assert(block_index < blocks_.Size());
+		const Block& block = blocks_[block_index];
+		UNPACKERS[block.width](words_.begin() + block.word_offset, block.base, out);
+		if (encoding_ == Encoding::Delta) {
+			// Первое смещение блока всегда нулевое, поэтому префиксная сумма восстанавливает значения
+			for (size_t i = 1; i < VALUES_PER_BLOCK; ++i) {
+				out[i] += out[i - 1] - block.base;
+			}
+		}
+		return std::min(VALUES_PER_BLOCK, size_ - block_index * VALUES_PER_BLOCK);
+	}
+
+	// Распаковывает все значения обратно в обычный вектор
+	SimpleVector<T> Thaw() const {
+		SimpleVector<T> result;
+		T* out = result.AppendUninitialized(size_);
+		std::array<T, VALUES_PER_BLOCK> tail;
+		for (size_t i = 0; i < blocks_.Size(); ++i) {
+			if (size_ - i * VALUES_PER_BLOCK >= VALUES_PER_BLOCK) {
+				DecodeBlock(i, out + i * VALUES_PER_BLOCK);
+			} else {
+				const size_t count = DecodeBlock(i, tail.data());
+				std::copy_n(tail.data(), count, out + i * VALUES_PER_BLOCK);
+			}
+		}
+		return result;
+	}
+
+private:
+	static constexpr unsigned MAX_WIDTH = sizeof(T) * 8;
+
+	struct Block {
+		T base = 0;
+		uint32_t width = 0;
+		size_t word_offset = 0;
+	};
+
+	static uint32_t BitWidth(T value) noexcept {
+		uint32_t width = 0;
+		for (; value != 0; value >>= 1) {
+			++width;
+		}
+		return width;
+	}
+
+	static constexpr uint64_t Mask(unsigned width) noexcept {
+		return width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+	}
+
+	static uint64_t Extract(const uint64_t* words, unsigned width, size_t index) noexcept {
+		if (width == 0) {
+			return 0;
+		}
+		const size_t bit = index * width;
+		const size_t word = bit / 64;
+		const unsigned shift = bit % 64;
+		uint64_t value = words[word] >> shift;
+		if (shift + width > 64) {
+			value |= words[word + 1] << (64 - shift);
+		}
+		return value & Mask(width);
+	}
+
+	static void Pack(const T* values, unsigned width, uint64_t* words) noexcept {
+		std::fill_n(words, 2 * width, uint64_t{0});
+		for (size_t i = 0; i < VALUES_PER_BLOCK && width != 0; ++i) {
+			const size_t bit = i * width;
+			const size_t word = bit / 64;
+			const unsigned shift = bit % 64;
+			words[word] |= static_cast<uint64_t>(values[i]) << shift;
+			if (shift + width > 64) {
+				words[word + 1] |= static_cast<uint64_t>(values[i]) >> (64 - shift);
+			}
+		}
+	}
+
+	// Распаковка блока с шириной, известной на этапе компиляции. После полной развёртки цикла
+	// номера слов, сдвиги и маски становятся константами, а ветвление по переносу через границу слова исчезает
+	template <unsigned Width>
+	static void Unpack(const uint64_t* words, T base, T* out) noexcept {
+		if constexpr (Width == 0) {
+			std::fill_n(out, VALUES_PER_BLOCK, base);
+		} else {
+#pragma GCC unroll 128
+			for (size_t i = 0; i < VALUES_PER_BLOCK; ++i) {
+				const size_t bit = i * Width;
+				const size_t word = bit / 64;
+				const unsigned shift = bit % 64;
+				uint64_t value = words[word] >> shift;
+				if (shift + Width > 64) {
+					value |= words[word + 1] << (64 - shift);
+				}
+				out[i] = base + static_cast<T>(value & Mask(Width));
+			}
+		}
+	}
+
+	using Unpacker = void (*)(const uint64_t*, T, T*) noexcept;
+
+	template <size_t... Widths>
+	static constexpr std::array<Unpacker, sizeof...(Widths)> MakeUnpackers(std::index_sequence<Widths...>) noexcept {
+		return {&Unpack<Widths>...};
+	}
+
+	static constexpr std::array<Unpacker, MAX_WIDTH + 1> UNPACKERS =
+			MakeUnpackers(std::make_index_sequence<MAX_WIDTH + 1>{});
+
+	SimpleVector<uint64_t> words_;
+	SimpleVector<Block> blocks_;
+	size_t size_ = 0;
+	Encoding encoding_ = Encoding::FrameOfReference;
+};
+
+template <typename T>
+FrozenVector<T> Freeze(const SimpleVector<T>& values) {
+	return FrozenVector<T>::Freeze(values);
+}
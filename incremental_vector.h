@@ -0,0 +1,147 @@
+#pragma once
+#include "simple_vector.h"
+
+#include <cassert>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Вектор без пауз на рост. Когда буфер заполнен, выделяется вдвое больший, но элементы остаются
+// в старом и переносятся в новый по MIGRATION_STEP за каждое последующее добавление. Индекс элемента
+// в обоих буферах одинаков, поэтому operator[] лишь выбирает буфер по диапазону ещё не перенесённых
+// индексов. Перенос заканчивается раньше, чем заполнится новый буфер, так что худшее время операции
+// ограничено выделением памяти и переносом MIGRATION_STEP элементов вместо всего содержимого.
+// Элементы не лежат в памяти непрерывно, пока идёт перенос, поэтому итераторов и Data() нет
+template <typename T>
+class IncrementalVector {
+	static_assert(std::is_nothrow_move_constructible_v<T>,
+	              "Incremental migration requires elements with a non-throwing move constructor");
+
+public:
+	static constexpr size_t MIGRATION_STEP = 4;
+
+	IncrementalVector() noexcept = default;
+
+	IncrementalVector(const IncrementalVector&) = delete;
+	IncrementalVector& operator=(const IncrementalVector&) = delete;
+
+	IncrementalVector(IncrementalVector&& other) noexcept {
+		Swap(other);
+	}
+
+	IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+		if (this != &rhs) {
+			IncrementalVector moved(std::move(rhs));
+			Swap(moved);
+		}
+		return *this;
+	}
+
+	~IncrementalVector() {
+		std::destroy_n(data_.GetAddress(), migrated_);
+		std::destroy_n(data_ + old_size_, size_ - old_size_);
+		std::destroy_n(old_ + migrated_, old_size_ - migrated_);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return data_.Capacity();
+	}
+
+	// Идёт ли перенос элементов из предыдущего буфера
+	bool IsMigrating() const noexcept {
+		return migrated_ < old_size_;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<IncrementalVector&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return index >= migrated_ && index < old_size_ ? old_[index] : data_[index];
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		if (size_ == data_.Capacity()) {
+			Grow();
+		}
+		// Старый буфер ещё жив, поэтому аргументы, ссылающиеся на элементы вектора, остаются действительными
+		T* slot = new(data_ + size_) T(std::forward<Args>(args)...);
+		++size_;
+		MigrateStep(MIGRATION_STEP);
+		return *slot;
+	}
+
+	void PopBack() noexcept {
+		assert(size_ != 0);
+		std::destroy_at(&(*this)[size_ - 1]);
+		--size_;
+		if (old_size_ > size_) {
+			old_size_ = size_;
+			ReleaseOldIfMigrated();
+		}
+	}
+
+	// Переносит все оставшиеся элементы и освобождает предыдущий буфер
+	void FinishMigration() noexcept {
+		MigrateStep(old_size_ - migrated_);
+	}
+
+	void Swap(IncrementalVector& other) noexcept {
+		data_.Swap(other.data_);
+		old_.Swap(other.old_);
+		std::swap(size_, other.size_);
+		std::swap(old_size_, other.old_size_);
+		std::swap(migrated_, other.migrated_);
+	}
+
+private:
+	void Grow() {
+		// После удвоения до заполнения нового буфера нужно столько же добавлений, сколько элементов
+		// переносится, а каждое добавление переносит MIGRATION_STEP элементов
+		assert(!IsMigrating());
+		RawMemory<T> new_data(DoublingGrowth::NextCapacity(size_));
+		old_.Swap(data_);
+		data_.Swap(new_data);
+		old_size_ = size_;
+		migrated_ = 0;
+		ReleaseOldIfMigrated();
+	}
+
+	void MigrateStep(size_t count) noexcept {
+		for (size_t i = 0; i < count && migrated_ < old_size_; ++i, ++migrated_) {
+			new(data_ + migrated_) T(std::move(old_[migrated_]));
+			std::destroy_at(old_ + migrated_);
+		}
+		ReleaseOldIfMigrated();
+	}
+
+	void ReleaseOldIfMigrated() noexcept {
+		if (migrated_ >= old_size_ && old_.Capacity() != 0) {
+			RawMemory<T> released;
+			old_.Swap(released);
+			// Все элементы в data_, и диапазон старого буфера пуст
+			old_size_ = migrated_ = 0;
+		}
+	}
+
+	RawMemory<T> data_;  // Текущий буфер: индексы [0, migrated_) и [old_size_, size_)
+	RawMemory<T> old_;  // Предыдущий буфер, пока идёт перенос: индексы [migrated_, old_size_)
+	size_t size_ = 0;
+	size_t old_size_ = 0;
+	size_t migrated_ = 0;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// Гистограмма задержек с логарифмически-линейными корзинами в духе HdrHistogram.
+// Значения меньше SUB_BUCKET_COUNT хранятся точно, а каждый следующий диапазон [2^m, 2^(m+1))
+// делится на SUB_BUCKET_COUNT / 2 равных корзин. Относительная погрешность не превышает
+// 2 / SUB_BUCKET_COUNT при любом значении, а объём не зависит от числа записей
+class LatencyHistogram {
+public:
+	static constexpr unsigned SUB_BUCKET_BITS = 7;
+	static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{1} << SUB_BUCKET_BITS;
+	static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * (SUB_BUCKET_COUNT / 2);
+
+	LatencyHistogram()
+			: counts_(BUCKET_COUNT) {
+	}
+
+	void Record(uint64_t value) noexcept {
+		++counts_[BucketIndex(value)];
+		++total_count_;
+		sum_ += value;
+		min_ = std::min(min_, value);
+		max_ = std::max(max_, value);
+	}
+
+	void Merge(const LatencyHistogram& other) noexcept {
+		for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+			counts_[i] += other.counts_[i];
+		}
+		total_count_ += other.total_count_;
+		sum_ += other.sum_;
+		min_ = std::min(min_, other.min_);
+		max_ = std::max(max_, other.max_);
+	}
+
+	void Reset() noexcept {
+		std::fill(counts_.begin(), counts_.end(), uint64_t{0});
+		total_count_ = 0;
+		sum_ = 0;
+		min_ = std::numeric_limits<uint64_t>::max();
+		max_ = 0;
+	}
+
+	uint64_t Count() const noexcept {
+		return total_count_;
+	}
+
+	uint64_t Min() const noexcept {
+		return total_count_ == 0 ? 0 : min_;
+	}
+
+	uint64_t Max() const noexcept {
+		return max_;
+	}
+
+	double Mean() const noexcept {
+		return total_count_ == 0 ? 0 : static_cast<double>(sum_) / static_cast<double>(total_count_);
+	}
+
+	// Значение, которого не превышают percentile процентов записей, с точностью до корзины.
+	// Возвращается верхняя граница корзины, но не больше максимума
+	uint64_t ValueAtPercentile(double percentile) const noexcept {
+		if (total_count_ == 0) {
+			return 0;
+		}
+		const double clamped = std::clamp(percentile, 0.0, 100.0);
+		const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total_count_) + 0.5));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+			seen += counts_[i];
+			if (seen >= target) {
+				return std::min(BucketUpperBound(i), max_);
+			}
+		}
+		return max_;
+	}
+
+private:
+	static unsigned MostSignificantBit(uint64_t value) noexcept {
+		return 63 - static_cast<unsigned>(__builtin_clzll(value));
+	}
+
+	static size_t BucketIndex(uint64_t value) noexcept {
+		if (value < SUB_BUCKET_COUNT) {
+			return static_cast<size_t>(value);
+		}
+		const unsigned magnitude = MostSignificantBit(value);
+		const unsigned shift = magnitude - SUB_BUCKET_BITS + 1;
+		return static_cast<size_t>(SUB_BUCKET_COUNT + (magnitude - SUB_BUCKET_BITS) * (SUB_BUCKET_COUNT / 2)
+		                           + ((value >> shift) - SUB_BUCKET_COUNT / 2));
+	}
+
+	static uint64_t BucketUpperBound(size_t index) noexcept {
+		if (index < SUB_BUCKET_COUNT) {
+			return index;
+		}
+		const size_t level = (index - SUB_BUCKET_COUNT) / (SUB_BUCKET_COUNT / 2);
+		const size_t sub_bucket = (index - SUB_BUCKET_COUNT) % (SUB_BUCKET_COUNT / 2) + SUB_BUCKET_COUNT / 2;
+		const unsigned shift = static_cast<unsigned>(level) + 1;
+		return ((static_cast<uint64_t>(sub_bucket) + 1) << shift) - 1;
+	}
+
+	SimpleVector<uint64_t> counts_;
+	uint64_t total_count_ = 0;
+	uint64_t sum_ = 0;
+	uint64_t min_ = std::numeric_limits<uint64_t>::max();
+	uint64_t max_ = 0;
+};
+
+// Замеряет время жизни объекта в наносекундах и записывает его в гистограмму. Оборачивает
+// отдельные операции на чувствительном к задержкам пути:
+//     {
+//         ScopedLatency latency(histogram);
+//         v.PushBack(value);
+//     }
+class ScopedLatency {
+public:
+	explicit ScopedLatency(LatencyHistogram& histogram) noexcept
+			: histogram_(histogram)
+			, start_(Clock::now()) {
+	}
+
+	ScopedLatency(const ScopedLatency&) = delete;
+	ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+	~ScopedLatency() {
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+		histogram_.Record(static_cast<uint64_t>(std::max<decltype(elapsed)>(elapsed, 0)));
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	LatencyHistogram& histogram_;
+	Clock::time_point start_;
+};
@@ -1,124 +1,28 @@
-#include "vector.h"
+#include "simple_vector.h"
+#include "serialization.h"
+#include "mapped_vector.h"
+#include "vector_view.h"
+#include "vector_io.h"
+#include "async_io.h"
+#include "checkpoint.h"
+#include "frozen_vector.h"
+#include "encoded_vector.h"
+#include "dict_vector.h"
+#include "incremental_vector.h"
+#include "preallocating_vector.h"
+#include "latency_histogram.h"
+#include "test_objects.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <vector>
-
-namespace {
-
-// "Магическое" число, используемое для отслеживания живости объекта
-	inline const uint32_t DEFAULT_COOKIE = 0xdeadbeef;
-	
-	struct TestObj {
-		TestObj() = default;
-		TestObj(const TestObj& other) = default;
-		TestObj& operator=(const TestObj& other) = default;
-		TestObj(TestObj&& other) = default;
-		TestObj& operator=(TestObj&& other) = default;
-		~TestObj() {
-			cookie = 0;
-		}
-		[[nodiscard]] bool IsAlive() const noexcept {
-			return cookie == DEFAULT_COOKIE;
-		}
-		uint32_t cookie = DEFAULT_COOKIE;
-	};
-	
-	struct Obj {
-		Obj() {
-			if (default_construction_throw_countdown > 0) {
-				if (--default_construction_throw_countdown == 0) {
-					throw std::runtime_error("Oops");
-				}
-			}
-			++num_default_constructed;
-		}
-		
-		explicit Obj(int id)
-				: id(id)  //
-		{
-			++num_constructed_with_id;
-		}
-		
-		Obj(int id, std::string name)
-				: id(id)
-				, name(std::move(name))  //
-		{
-			++num_constructed_with_id_and_name;
-		}
-		
-		Obj(const Obj& other)
-				: id(other.id)  //
-		{
-			if (other.throw_on_copy) {
-				throw std::runtime_error("Oops");
-			}
-			++num_copied;
-		}
-		
-		Obj(Obj&& other) noexcept
-				: id(other.id)  //
-		{
-			++num_moved;
-		}
-		
-		Obj& operator=(const Obj& other) {
-			if (this != &other) {
-				id = other.id;
-				name = other.name;
-				++num_assigned;
-			}
-			return *this;
-		}
-		
-		Obj& operator=(Obj&& other) noexcept {
-			if (this != &other) {
-				id = other.id;
-				name = std::move(other.name);
-				++num_move_assigned;
-			}
-			return *this;
-		}
-		
-		~Obj() {
-			++num_destroyed;
-			id = 0;
-		}
-		
-		static int GetAliveObjectCount() {
-			return num_default_constructed + num_copied + num_moved + num_constructed_with_id
-			       + num_constructed_with_id_and_name - num_destroyed;
-		}
-		
-		static void ResetCounters() {
-			default_construction_throw_countdown = 0;
-			num_default_constructed = 0;
-			num_copied = 0;
-			num_moved = 0;
-			num_destroyed = 0;
-			num_constructed_with_id = 0;
-			num_constructed_with_id_and_name = 0;
-			num_assigned = 0;
-			num_move_assigned = 0;
-		}
-		
-		bool throw_on_copy = false;
-		int id = 0;
-		std::string name;
-		
-		static inline int default_construction_throw_countdown = 0;
-		static inline int num_default_constructed = 0;
-		static inline int num_constructed_with_id = 0;
-		static inline int num_constructed_with_id_and_name = 0;
-		static inline int num_copied = 0;
-		static inline int num_moved = 0;
-		static inline int num_destroyed = 0;
-		static inline int num_assigned = 0;
-		static inline int num_move_assigned = 0;
-	};
-	
-}  // namespace
 
 void Test1() {
 	Obj::ResetCounters();
@@ -289,7 +193,7 @@ void Test3() {
 		v_small = v;
 		assert(v_small.Size() == v.Size());
 		assert(v_small.Capacity() == MEDIUM_SIZE + 1);
-		v_small[MEDIUM_SIZE - 1].id = ID;
+		assert(v_small[MEDIUM_SIZE - 1].id == ID);
 		assert(Obj::num_copied - num_copies == MEDIUM_SIZE - (MEDIUM_SIZE / 2));
 	}
 }
@@ -612,85 +516,1643 @@ void Test6() {
 	}
 }
 
-struct C {
-	C() noexcept {
-		++def_ctor;
+void Test7() {
+	const size_t SIZE = 100'500;
+	{
+		SimpleVector<uint64_t> v;
+		for (size_t i = 0; i < SIZE; ++i) {
+			v.PushBack(i * i);
+		}
+		std::stringstream stream;
+		Save(stream, v);
+		assert(stream.str().size() == sizeof(VectorFileHeader) + SIZE * sizeof(uint64_t));
+		const auto loaded = Load<uint64_t>(stream);
+		assert(loaded.Size() == SIZE);
+		assert(loaded.Capacity() == SIZE);
+		assert(std::equal(v.begin(), v.end(), loaded.begin()));
 	}
-	C(const C& /*other*/) noexcept {
-		++copy_ctor;
+	{
+		std::stringstream stream;
+		Save(stream, SimpleVector<int>{});
+		const auto loaded = Load<int>(stream);
+		assert(loaded.Size() == 0);
 	}
-	C(C&& /*other*/) noexcept {
-		++move_ctor;
+	{
+		std::stringstream stream;
+		Save(stream, SimpleVector<int>(SIZE));
+		std::string bytes = stream.str();
+		bytes[sizeof(VectorFileHeader) + 10] ^= 1;
+		std::stringstream corrupted(bytes);
+		try {
+			Load<int>(corrupted);
+			assert(false && "Exception is expected");
+		} catch (const SerializationError&) {
+		}
+		std::stringstream truncated(stream.str().substr(0, bytes.size() - 1));
+		try {
+			Load<int>(truncated);
+			assert(false && "Exception is expected");
+		} catch (const SerializationError&) {
+		}
+		std::stringstream wrong_type(stream.str());
+		try {
+			Load<double>(wrong_type);
+			assert(false && "Exception is expected");
+		} catch (const SerializationError&) {
+		}
 	}
-	C& operator=(const C& other) noexcept {
-		if (this != &other) {
-			++copy_assign;
+	{
+		// Повреждённое число элементов обнаруживается до выделения буфера, в том числе в потоке
+		// без позиционирования, который читается частями
+		struct ForwardOnlyBuffer : std::stringbuf {
+			using std::stringbuf::stringbuf;
+			pos_type seekoff(off_type, std::ios::seekdir, std::ios::openmode) override {
+				return pos_type(-1);
+			}
+		};
+		std::stringstream stream;
+		Save(stream, SimpleVector<int>(SIZE));
+		std::string bytes = stream.str();
+		const uint64_t huge_count = uint64_t{1} << 60;
+		std::memcpy(&bytes[offsetof(VectorFileHeader, count)], &huge_count, sizeof(huge_count));
+		std::stringstream seekable(bytes);
+		ForwardOnlyBuffer forward_only_buffer(bytes);
+		std::istream forward_only(&forward_only_buffer);
+		for (std::istream* in : {static_cast<std::istream*>(&seekable), &forward_only}) {
+			try {
+				Load<int>(*in);
+				assert(false && "Exception is expected");
+			} catch (const SerializationError&) {
+			}
+		}
+		ForwardOnlyBuffer intact_buffer(stream.str());
+		std::istream intact(&intact_buffer);
+		assert(Load<int>(intact).Size() == SIZE);
+	}
+}
+
+void Test8() {
+	const size_t SIZE = 100'500;
+	char path[] = "/tmp/simple_vector_test_XXXXXX";
+	const int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	{
+		MappedVector<uint32_t> v(path);
+		assert(v.Size() == 0);
+		assert(v.Capacity() == 0);
+		assert(!v.IsDirty());
+		for (size_t i = 0; i < SIZE; ++i) {
+			v.PushBack(static_cast<uint32_t>(i));
 		}
-		return *this;
+		assert(v.Size() == SIZE);
+		assert(v.Capacity() >= SIZE);
+		v[0] = 42;
+		v.PushBack(v[0]);
+		assert(v[SIZE] == 42);
+		v.PopBack();
+		assert(v.IsDirty());
+		v.Close();
+		assert(v.Size() == 0 && !v.IsDirty());
+	}
+	{
+		// Чтение через константную ссылку не делает вектор изменённым, и закрытие не читает файл
+		MappedVector<uint32_t> v(path);
+		const MappedVector<uint32_t>& view = v;
+		assert(view[SIZE - 1] == SIZE - 1);
+		assert(!v.IsDirty());
+		v.Sync();
+		assert(!v.IsDirty());
 	}
-	C& operator=(C&& /*other*/) noexcept {
-		++move_assign;
-		return *this;
+	{
+		// Изменения без Sync: деструктор всё равно обновляет контрольную сумму
+		MappedVector<uint32_t> v(path);
+		v[1] = 1;
+		assert(v.IsDirty());
+	}
+	{
+		const MappedVector<const uint32_t> v(path);
+		assert(v.Size() == SIZE);
+		assert(v[0] == 42);
+		assert(v[SIZE - 1] == SIZE - 1);
+		assert(v.VerifyChecksum());
+	}
+	{
+		// Отображение только для чтения и через неконстантную ссылку даёт лишь константный доступ
+		using ReadOnly = MappedVector<const uint32_t>;
+		static_assert(!ReadOnly::IsWritable() && MappedVector<uint32_t>::IsWritable());
+		static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>()[0]), const uint32_t&>);
+		static_assert(std::is_same_v<decltype(std::declval<ReadOnly&>().begin()), const uint32_t*>);
+		ReadOnly v(path);
+		assert(*v.begin() == 42 && v[1] == 1);
+		assert(!v.IsDirty());
+		v.Close();
+		assert(v.Size() == 0);
+	}
+	{
+		// Штатно закрытый файл читается обычной загрузкой, а сохранённый вектор — отображением
+		std::ifstream in(path, std::ios::binary);
+		auto loaded = Load<uint32_t>(in);
+		assert(loaded.Size() == SIZE);
+		assert(loaded[1] == 1);
+		loaded.PushBack(7);
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		Save(out, loaded);
+	}
+	{
+		MappedVector<uint32_t> v(path);
+		assert(v.Size() == SIZE + 1);
+		assert(v.Capacity() == SIZE + 1);
+		assert(v[SIZE] == 7);
+		v.Reserve(SIZE * 2);
+		assert(v.Capacity() == SIZE * 2);
+		assert(v[SIZE] == 7);
 	}
-	~C() {
-		++dtor;
+	try {
+		MappedVector<const uint64_t> v(path);
+		assert(false && "Exception is expected");
+	} catch (const SerializationError&) {
 	}
+	unlink(path);
+}
+
+namespace {
 	
-	static void Reset() {
-		def_ctor = 0;
-		copy_ctor = 0;
-		move_ctor = 0;
-		copy_assign = 0;
-		move_assign = 0;
-		dtor = 0;
+	int64_t Sum(VectorView<int> view) {
+		return std::accumulate(view.begin(), view.end(), int64_t{0});
 	}
 	
-	inline static size_t def_ctor = 0;
-	inline static size_t copy_ctor = 0;
-	inline static size_t move_ctor = 0;
-	inline static size_t copy_assign = 0;
-	inline static size_t move_assign = 0;
-	inline static size_t dtor = 0;
-};
+}  // namespace
 
-void Dump() {
-	using namespace std;
-	cerr << "Def ctors: "sv << C::def_ctor              //
-	     << ", Copy ctors: "sv << C::copy_ctor          //
-	     << ", Move ctors: "sv << C::move_ctor          //
-	     << ", Copy assignments: "sv << C::copy_assign  //
-	     << ", Move assignments: "sv << C::move_assign  //
-	     << ", Dtors: "sv << C::dtor << endl;
+void Test9() {
+	const size_t SIZE = 100;
+	SimpleVector<int> v;
+	for (size_t i = 0; i < SIZE; ++i) {
+		v.PushBack(static_cast<int>(i));
+	}
+	{
+		VectorView<int> view = v;
+		assert(view.Size() == SIZE);
+		assert(view.Data() == &v[0]);
+		assert(view.IsContiguous());
+		assert(&view[10] == &v[10]);
+		assert(Sum(v) == static_cast<int64_t>(SIZE * (SIZE - 1) / 2));
+		assert(std::equal(view.begin(), view.end(), v.begin(), v.end()));
+	}
+	{
+		const VectorView<int> view(v);
+		const auto slice = view.Subview(10, 5);
+		assert(slice.Size() == 5);
+		assert(slice[0] == 10);
+		assert(slice[4] == 14);
+		assert(view.Subview(95).Size() == 5);
+		assert(view.Subview(SIZE).IsEmpty());
+		
+		const auto even = view.EveryNth(2);
+		assert(even.Size() == SIZE / 2);
+		assert(!even.IsContiguous());
+		assert(even[3] == 6);
+		assert(even.end() - even.begin() == static_cast<std::ptrdiff_t>(SIZE / 2));
+		assert(Sum(even) == static_cast<int64_t>(SIZE / 2 * (SIZE / 2 - 1)));
+		
+		const auto every_sixth_odd = view.Subview(1).EveryNth(3).EveryNth(2);
+		assert(every_sixth_odd.Size() == 17);
+		assert(every_sixth_odd[1] == 7);
+		assert(every_sixth_odd[16] == 97);
+		assert(*(every_sixth_odd.end() - 1) == 97);
+	}
+	{
+		char path[] = "/tmp/simple_vector_test_XXXXXX";
+		const int fd = mkstemp(path);
+		assert(fd >= 0);
+		close(fd);
+		{
+			MappedVector<int> mapped(path);
+			for (const int x : v) {
+				mapped.PushBack(x);
+			}
+		}
+		const MappedVector<const int> mapped(path);
+		assert(Sum(mapped) == Sum(v));
+		std::stringstream stream;
+		Save(stream, VectorView<int>(mapped).Subview(50));
+		assert(Load<int>(stream)[0] == 50);
+		
+		// Прорежённое представление сохраняется поэлементно, без промежутков
+		std::stringstream strided;
+		Save(strided, VectorView<int>(mapped).Subview(1).EveryNth(3));
+		const auto every_third = Load<int>(strided);
+		assert(every_third.Size() == 33);
+		assert(every_third[0] == 1 && every_third[1] == 4 && every_third[32] == 97);
+		unlink(path);
+	}
 }
 
-void Benchmark() {
-	using namespace std;
-	try {
-		const size_t NUM = 10;
-		C c;
+void Test10() {
+	const size_t SIZE = 1'000'000;
+	SimpleVector<char> data;
+	for (size_t i = 0; i < SIZE; ++i) {
+		data.PushBack(static_cast<char>('a' + i % 26));
+	}
+	{
+		FILE* file = std::tmpfile();
+		assert(file != nullptr);
+		const int fd = fileno(file);
+		WriteAll(fd, data);
+		assert(lseek(fd, 0, SEEK_SET) == 0);
+		
+		SimpleVector<char> buffer;
+		buffer.PushBack('!');
+		size_t total = 0;
+		while (const size_t received = ReadAppend(buffer, fd, 64 * 1024)) {
+			total += received;
+			assert(buffer.Size() == total + 1);
+		}
+		assert(total == SIZE);
+		assert(buffer[0] == '!');
+		assert(std::equal(data.begin(), data.end(), buffer.begin() + 1));
+		// Ёмкость растёт геометрически, а не на размер каждой порции, и проверка конца файла её не удваивает
+		assert(buffer.Capacity() < 2 * SIZE);
+		
+		// Буфер ровно под размер файла дочитывается без роста
+		assert(lseek(fd, 0, SEEK_SET) == 0);
+		SimpleVector<char> exact;
+		exact.Reserve(SIZE);
+		while (ReadAppend(exact, fd, 64 * 1024) != 0) {
+		}
+		assert(exact.Size() == SIZE && exact.Capacity() == SIZE);
+		std::fclose(file);
+	}
+	{
+		std::istringstream in(std::string(data.begin(), data.end()));
+		SimpleVector<uint8_t> buffer;
+		buffer.Reserve(SIZE / 3);
+		assert(ReadAppend(buffer, in) == SIZE);
+		assert(buffer.Size() == SIZE);
+		assert(buffer.Capacity() < 2 * SIZE);
+		assert(std::equal(data.begin(), data.end(), buffer.begin()));
+		
+		std::istringstream exact_in(std::string(data.begin(), data.end()));
+		SimpleVector<char> exact;
+		exact.Reserve(SIZE);
+		assert(ReadAppend(exact, exact_in) == SIZE);
+		assert(exact.Capacity() == SIZE);
+		
+		std::istringstream empty;
+		assert(ReadAppend(buffer, empty) == 0);
+		assert(buffer.Size() == SIZE);
+	}
+	{
+		// Прорежённое представление длиннее одной порции сборки записывается без промежутков
+		FILE* file = std::tmpfile();
+		assert(file != nullptr);
+		const int fd = fileno(file);
+		const auto every_seventh = VectorView<char>(data).EveryNth(7);
+		WriteAll(fd, every_seventh);
+		assert(lseek(fd, 0, SEEK_SET) == 0);
+		SimpleVector<char> buffer;
+		while (ReadAppend(buffer, fd, 64 * 1024) != 0) {
+		}
+		assert(buffer.Size() == every_seventh.Size());
+		assert(std::equal(every_seventh.begin(), every_seventh.end(), buffer.begin()));
+		std::fclose(file);
+	}
+	{
+		int fds[2];
+		assert(pipe(fds) == 0);
+		WriteAll(fds[1], VectorView<char>(data).Subview(0, 1000));
+		close(fds[1]);
+		SimpleVector<char> buffer;
+		assert(ReadAppend(buffer, fds[0], SIZE) == 1000);
+		assert(ReadAppend(buffer, fds[0], SIZE) == 0);
+		assert(buffer.Size() == 1000);
+		assert(buffer[999] == data[999]);
+		close(fds[0]);
+	}
+}
+
+void Test11() {
+	// Записей больше, чем IOV_MAX, чтобы запись и чтение шли несколькими вызовами
+	const size_t COUNT = 3000;
+	SimpleVector<SimpleVector<char>> records;
+	size_t total = 0;
+	for (size_t i = 0; i < COUNT; ++i) {
+		SimpleVector<char> record;
+		for (size_t j = 0; j < i % 37; ++j) {
+			record.PushBack(static_cast<char>('a' + (i + j) % 26));
+		}
+		total += record.Size();
+		records.PushBack(std::move(record));
+	}
+	FILE* file = std::tmpfile();
+	assert(file != nullptr);
+	const int fd = fileno(file);
+	assert(WriteVectored(fd, records) == total);
+	assert(static_cast<size_t>(lseek(fd, 0, SEEK_CUR)) == total);
+	assert(lseek(fd, 0, SEEK_SET) == 0);
+	{
+		SimpleVector<SimpleVector<char>> loaded(COUNT);
+		for (size_t i = 0; i < COUNT; ++i) {
+			loaded[i].Reserve(records[i].Size());
+		}
+		assert(ReadVectored(fd, loaded) == total);
+		for (size_t i = 0; i < COUNT; ++i) {
+			assert(loaded[i].Size() == records[i].Size());
+			assert(std::equal(records[i].begin(), records[i].end(), loaded[i].begin()));
+		}
+	}
+	{
+		// Файл короче суммарной ёмкости: последняя запись заполняется частично
+		assert(lseek(fd, 0, SEEK_SET) == 0);
+		SimpleVector<SimpleVector<char>> loaded(2);
+		loaded[0].PushBack('!');
+		loaded[0].Reserve(10);
+		loaded[1].Reserve(total);
+		assert(ReadVectored(fd, loaded) == total);
+		assert(loaded[0].Size() == 10);
+		assert(loaded[0][0] == '!');
+		assert(loaded[1].Size() == total - 9);
+		assert(loaded[1][0] == records[4][3]);
+	}
+	std::fclose(file);
+}
+
+void Test12() {
+	const size_t SIZE = 1'000'000;
+	SimpleVector<uint32_t> v;
+	for (size_t i = 0; i < SIZE; ++i) {
+		v.PushBack(static_cast<uint32_t>(i * 7));
+	}
+	for (const AsyncBackend backend : {AsyncBackend::Auto, AsyncBackend::Sync}) {
+		char path[] = "/tmp/simple_vector_test_XXXXXX";
+		const int fd = mkstemp(path);
+		assert(fd >= 0);
+		AsyncFileIo io(4, backend);
+		assert(io.QueueDepth() == 4);
+		assert(backend == AsyncBackend::Auto || !io.UsesUring());
+		{
+			int calls = 0;
+			std::error_code error = std::make_error_code(std::errc::io_error);
+			// Частей больше, чем глубина очереди: отправка ждёт освобождения слотов
+			AsyncSave(io, fd, v, [&](std::error_code ec) {
+				++calls;
+				error = ec;
+			}, 64 * 1024);
+			io.WaitAll();
+			assert(io.InFlight() == 0);
+			assert(calls == 1);
+			assert(!error);
+			std::ifstream in(path, std::ios::binary);
+			const auto loaded = Load<uint32_t>(in);
+			assert(std::equal(v.begin(), v.end(), loaded.begin(), loaded.end()));
+		}
+		{
+			SimpleVector<uint32_t> loaded;
+			int calls = 0;
+			std::error_code error = std::make_error_code(std::errc::io_error);
+			AsyncLoad(io, fd, loaded, [&](std::error_code ec) {
+				++calls;
+				error = ec;
+			}, 64 * 1024);
+			io.WaitAll();
+			assert(calls == 1);
+			assert(!error);
+			assert(std::equal(v.begin(), v.end(), loaded.begin(), loaded.end()));
+		}
 		{
-			cerr << "std::vector:"sv << endl;
-			C::Reset();
-			vector<C> v(NUM);
-			Dump();
-			v.push_back(c);
+			// Порча данных обнаруживается по контрольной сумме
+			const char garbage = 1;
+			assert(pwrite(fd, &garbage, 1, sizeof(VectorFileHeader) + 100) == 1);
+			SimpleVector<uint32_t> loaded;
+			std::error_code error;
+			AsyncLoad(io, fd, loaded, [&](std::error_code ec) {
+				error = ec;
+			});
+			io.WaitAll();
+			assert(error == std::errc::illegal_byte_sequence);
 		}
-		Dump();
-	} catch (...) {
+		{
+			// Повреждённое число элементов отклоняется до выделения буфера
+			const uint64_t huge_count = uint64_t{1} << 60;
+			assert(pwrite(fd, &huge_count, sizeof(huge_count), offsetof(VectorFileHeader, count)) == sizeof(huge_count));
+			SimpleVector<uint32_t> loaded;
+			try {
+				AsyncLoad(io, fd, loaded, [](std::error_code) {
+					assert(false && "Callback is not expected");
+				});
+				assert(false && "Exception is expected");
+			} catch (const SerializationError&) {
+			}
+			assert(loaded.Capacity() == 0);
+		}
+		{
+			SimpleVector<uint32_t> empty;
+			bool done = false;
+			assert(ftruncate(fd, 0) == 0);
+			AsyncSave(io, fd, empty, [&](std::error_code ec) {
+				done = !ec;
+			});
+			io.WaitAll();
+			assert(done);
+		}
+		close(fd);
+		unlink(path);
 	}
-	try {
-		const size_t NUM = 10;
-		C c;
+}
+
+void Test13() {
+	const size_t SIZE = 10'000;
+	SimpleVector<uint64_t> v;
+	for (size_t i = 0; i < SIZE; ++i) {
+		v.PushBack(i);
+	}
+	VectorCheckpointer<uint64_t> checkpointer(v);
+	std::stringstream base;
+	std::stringstream deltas;
+	checkpointer.WriteBase(base);
+	assert(checkpointer.HighWaterMark() == SIZE);
+	{
+		// Пустая дельта содержит только заголовок
+		checkpointer.WriteDelta(deltas);
+		assert(deltas.str().size() == sizeof(VectorDeltaHeader));
+	}
+	{
+		v.PushBack(100);
+		v.PushBack(200);
+		v[5] = 55;
+		checkpointer.MarkDirty(5);
+		v[7] = 77;
+		v[8] = 88;
+		checkpointer.MarkDirty(7, 2);
+		checkpointer.MarkDirty(6, 2);
+		const size_t before = deltas.str().size();
+		checkpointer.WriteDelta(deltas);
+		// Диапазоны [5, 9) и [SIZE, SIZE + 2) вместо всего вектора
+		assert(deltas.str().size() - before
+		       == sizeof(VectorDeltaHeader) + 2 * sizeof(VectorDeltaRange) + 6 * sizeof(uint64_t));
+		assert(checkpointer.HighWaterMark() == SIZE + 2);
+	}
+	{
+		v.Resize(SIZE - 10);
+		checkpointer.NoteShrink(SIZE - 10);
+		v[0] = 1000;
+		checkpointer.MarkDirty(0);
+		checkpointer.MarkDirty(SIZE - 5);
+		checkpointer.WriteDelta(deltas);
+	}
+	{
+		std::stringstream base_copy(base.str());
+		std::stringstream deltas_copy(deltas.str());
+		const auto recovered = Recover<uint64_t>(base_copy, deltas_copy);
+		assert(recovered.Size() == v.Size());
+		assert(std::equal(v.begin(), v.end(), recovered.begin()));
+	}
+	const std::string complete_log = deltas.str();
+	{
+		// Оборванная последняя запись игнорируется
+		v.PushBack(1);
+		v.PushBack(2);
+		checkpointer.WriteDelta(deltas);
+		const std::string log = deltas.str();
+		std::stringstream base_copy(base.str());
+		std::stringstream torn(log.substr(0, log.size() - 3));
+		const auto recovered = Recover<uint64_t>(base_copy, torn);
+		assert(recovered.Size() == SIZE - 10);
+		assert(recovered[0] == 1000);
+	}
+	for (const size_t offset : {complete_log.size() - 1, offsetof(VectorDeltaHeader, size)}) {
+		// Повреждение и содержимого, и размера в заголовке обнаруживается контрольной суммой
+		std::string corrupted = complete_log;
+		corrupted[offset] ^= 1;
+		std::stringstream base_copy(base.str());
+		std::stringstream deltas_copy(corrupted);
+		try {
+			Recover<uint64_t>(base_copy, deltas_copy);
+			assert(false && "Exception is expected");
+		} catch (const SerializationError&) {
+		}
+	}
+	{
+		// Повреждённые длины не приводят к выделению памяти сверх оставшейся длины журнала:
+		// огромное число диапазонов читается как оборванная запись, а диапазон, переполняющий
+		// uint64_t при сложении, отклоняется проверкой границ
+		const size_t record = sizeof(VectorDeltaHeader);
+		const uint64_t huge_count = uint64_t{1} << 60;
+		std::string huge_ranges = complete_log;
+		std::memcpy(&huge_ranges[record + offsetof(VectorDeltaHeader, range_count)], &huge_count, sizeof(huge_count));
+		std::stringstream base_copy(base.str());
+		std::stringstream deltas_copy(huge_ranges);
+		assert(Recover<uint64_t>(base_copy, deltas_copy).Size() == SIZE);
+		
+		const VectorDeltaRange wrapping{5, std::numeric_limits<uint64_t>::max()};
+		std::string wrapped = complete_log;
+		std::memcpy(&wrapped[2 * record], &wrapping, sizeof(wrapping));
+		base_copy.str(base.str());
+		std::stringstream wrapped_deltas(wrapped);
+		try {
+			Recover<uint64_t>(base_copy, wrapped_deltas);
+			assert(false && "Exception is expected");
+		} catch (const SerializationError&) {
+		}
+	}
+	{
+		// Элементы, удалённые и добавленные заново между точками, попадают в дельту
+		SimpleVector<uint64_t> small;
+		for (uint64_t i = 0; i < 10; ++i) {
+			small.PushBack(i);
+		}
+		VectorCheckpointer<uint64_t> small_checkpointer(small);
+		std::stringstream small_base;
+		std::stringstream small_deltas;
+		small_checkpointer.WriteBase(small_base);
+		small.PopBack();
+		small.PopBack();
+		small_checkpointer.NoteShrink(small.Size());
+		small.PushBack(100);
+		small.PushBack(200);
+		assert(small_checkpointer.LowWaterMark() == 8);
+		small_checkpointer.WriteDelta(small_deltas);
+		assert(small_checkpointer.LowWaterMark() == 10);
+		const auto recovered = Recover<uint64_t>(small_base, small_deltas);
+		assert(recovered.Size() == 10 && recovered[8] == 100 && recovered[9] == 200);
+	}
+}
+
+void Test14() {
+	const size_t SIZE = 10'000;
+	{
+		SimpleVector<uint32_t> v;
+		for (size_t i = 0; i < SIZE; ++i) {
+			v.PushBack(static_cast<uint32_t>(1'000'000 + (i * 7919) % 1000));
+		}
+		const auto frozen = Freeze(v);
+		assert(frozen.Size() == SIZE);
+		assert(frozen.GetEncoding() == FrozenVector<uint32_t>::Encoding::FrameOfReference);
+		// Смещения укладываются в 10 бит вместо 32
+		assert(frozen.CompressedBytes() < SIZE * sizeof(uint32_t) / 2);
+		for (size_t i = 0; i < SIZE; ++i) {
+			assert(frozen[i] == v[i]);
+		}
+		const auto thawed = frozen.Thaw();
+		assert(std::equal(v.begin(), v.end(), thawed.begin(), thawed.end()));
+	}
+	{
+		SimpleVector<uint64_t> v;
+		uint64_t value = uint64_t{1} << 40;
+		for (size_t i = 0; i < SIZE + 17; ++i) {
+			value += i % 5;
+			v.PushBack(value);
+		}
+		const auto frozen = Freeze(v);
+		assert(frozen.GetEncoding() == FrozenVector<uint64_t>::Encoding::Delta);
+		assert(frozen.CompressedBytes() < v.Size() * sizeof(uint64_t) / 10);
+		for (size_t i = 0; i < v.Size(); ++i) {
+			assert(frozen[i] == v[i]);
+		}
+		uint64_t block[FrozenVector<uint64_t>::VALUES_PER_BLOCK];
+		assert(frozen.DecodeBlock(frozen.BlockCount() - 1, block) == (SIZE + 17) % FrozenVector<uint64_t>::VALUES_PER_BLOCK);
+		assert(block[0] == v[(frozen.BlockCount() - 1) * FrozenVector<uint64_t>::VALUES_PER_BLOCK]);
+		const auto thawed = frozen.Thaw();
+		assert(std::equal(v.begin(), v.end(), thawed.begin(), thawed.end()));
+	}
+	{
+		// Полная ширина 64 бита и пустой вектор
+		SimpleVector<uint64_t> v;
+		v.PushBack(~uint64_t{0});
+		v.PushBack(0);
+		v.PushBack(12345);
+		const auto frozen = Freeze(v);
+		assert(frozen[0] == ~uint64_t{0});
+		assert(frozen[1] == 0);
+		assert(frozen[2] == 12345);
+		assert(Freeze(SimpleVector<uint32_t>{}).Thaw().Size() == 0);
+	}
+}
+
+void Test15() {
+	const size_t SIZE = 10'000;
+	EncodedVector multiples_of_3;
+	EncodedVector multiples_of_5;
+	SimpleVector<uint32_t> expected;
+	for (uint32_t i = 0; i < SIZE; ++i) {
+		multiples_of_3.Append(i * 3);
+		if (i % 5 == 0) {
+			expected.PushBack(i * 3);
+		}
+	}
+	// Большие разности, занимающие все четыре байта
+	for (uint32_t i = 0; i < SIZE / 2; ++i) {
+		multiples_of_5.Append(i * 5);
+	}
+	multiples_of_5.Append(4'000'000'000u);
+	multiples_of_5.Append(4'000'000'000u);
+	assert(multiples_of_3.Size() == SIZE);
+	assert(multiples_of_3.CompressedBytes() < SIZE * sizeof(uint32_t) / 2);
+	{
+		const auto decoded = multiples_of_5.Decode();
+		assert(decoded.Size() == SIZE / 2 + 2);
+		assert(decoded[SIZE / 2 - 1] == (SIZE / 2 - 1) * 5);
+		assert(decoded[SIZE / 2] == 4'000'000'000u);
+		const auto all = multiples_of_3.Decode();
+		for (uint32_t i = 0; i < SIZE; ++i) {
+			assert(all[i] == i * 3);
+		}
+	}
+	{
+		SimpleVector<uint32_t> scratch;
+		multiples_of_3.DecodeBlock(2, scratch);
+		assert(scratch.Size() == EncodedVector::VALUES_PER_BLOCK);
+		assert(scratch[0] == 2 * EncodedVector::VALUES_PER_BLOCK * 3);
+		multiples_of_3.DecodeBlock(multiples_of_3.BlockCount() - 1, scratch);
+		assert(scratch.Size() == SIZE % EncodedVector::VALUES_PER_BLOCK);
+		assert(scratch[scratch.Size() - 1] == (SIZE - 1) * 3);
+	}
+	{
+		EncodedVector::Reader reader(multiples_of_3);
+		assert(reader.Value() == 0);
+		reader.Next();
+		assert(reader.Value() == 3);
+		assert(reader.SeekTo(1000));
+		assert(reader.Value() == 1002);
+		assert(reader.SeekTo(1002));
+		assert(reader.Value() == 1002);
+		assert(reader.SeekTo(3 * (SIZE - 1)));
+		assert(!reader.SeekTo(3 * SIZE));
+		assert(reader.IsEnd());
+	}
+	{
+		const auto common = Intersect(multiples_of_3, multiples_of_5);
+		assert(common.Size() == SIZE / 2 / 3 + 1);
+		assert(std::equal(common.begin(), common.end(), expected.begin()));
+		assert(Intersect(multiples_of_5, EncodedVector{}).Size() == 0);
+	}
+#if defined(SIMPLE_VECTOR_HAS_SSSE3_DECODE)
+	if (__builtin_cpu_supports("ssse3")) {
+		// Проверки выше прошли через pshufb, а он даёт то же, что побайтовая распаковка, при любых длинах
+		assert(EncodedVector::IsVectorized());
+		uint8_t data[32];
+		std::iota(std::begin(data), std::end(data), uint8_t{1});
+		for (unsigned control = 0; control < 256; ++control) {
+			uint32_t scalar[4];
+			uint32_t vectorized[4];
+			const uint8_t* scalar_next = detail::DecodeStreamVByteGroupScalar(static_cast<uint8_t>(control), data, scalar);
+			const uint8_t* vectorized_next = detail::DecodeStreamVByteGroupSsse3(static_cast<uint8_t>(control), data, vectorized);
+			assert(scalar_next == vectorized_next);
+			assert(std::equal(std::begin(scalar), std::end(scalar), std::begin(vectorized)));
+		}
+	}
+#endif
+}
+
+void Test16() {
+	using namespace std::literals;
+	const size_t SIZE = 100'000;
+	{
+		SimpleVector<std::string> column;
+		const std::string cities[] = {"Moscow"s, "Kazan"s, "Samara"s, "Tver"s};
+		for (size_t i = 0; i < SIZE; ++i) {
+			column.PushBack(cities[i * i % 4]);
+		}
+		const DictVector<std::string> dict(column);
+		assert(dict.Size() == SIZE);
+		assert(dict.DictionarySize() == 2);
+		assert(dict.CodeWidth() == 1);
+		for (size_t i = 0; i < SIZE; ++i) {
+			assert(dict[i] == column[i]);
+		}
+		assert(dict.CountEqual("Moscow"s) == SIZE / 2);
+		assert(dict.CountEqual("Tver"s) == 0);
+		const auto kazan = dict.FindEqual("Kazan"s);
+		assert(kazan.Size() == SIZE / 2);
+		assert(kazan[0] == 1);
+		assert(kazan[1] == 3);
+		assert(dict.FindEqual("Omsk"s).Size() == 0);
+		const auto decoded = dict.Decode();
+		assert(std::equal(column.begin(), column.end(), decoded.begin(), decoded.end()));
+	}
+	{
+		// Ширина кода растёт вместе со словарём, а уже записанные строки сохраняются
+		DictVector<uint64_t> dict;
+		for (uint64_t i = 0; i < 256; ++i) {
+			dict.PushBack(i * 1000);
+		}
+		assert(dict.CodeWidth() == 1);
+		dict.PushBack(7);
+		assert(dict.CodeWidth() == 2);
+		for (uint64_t i = 0; i < 70'000; ++i) {
+			dict.PushBack(i * 1000 + 1);
+		}
+		assert(dict.CodeWidth() == 4);
+		assert(dict.DictionarySize() == 256 + 1 + 70'000);
+		assert(dict[255] == 255'000);
+		assert(dict[256] == 7);
+		assert(dict[dict.Size() - 1] == 69'999'001);
+		assert(dict.CountEqual(1001) == 1);
+	}
+}
+
+void Test17() {
+	struct Plain {
+		int value = 0;
+	};
+	// Перемещение может бросить исключение, поэтому при росте вектор копирует элементы
+	struct ThrowingMove {
+		explicit ThrowingMove(int value)
+				: value(value) {
+		}
+		ThrowingMove(const ThrowingMove&) = default;
+		ThrowingMove(ThrowingMove&& other) noexcept(false)
+				: value(other.value) {
+		}
+		ThrowingMove& operator=(const ThrowingMove&) = default;
+		int value;
+	};
+	// Политика не хранит состояния в самом векторе
+	static_assert(sizeof(SimpleVector<Plain, CountingInstrumentation>) == sizeof(SimpleVector<Plain, NoInstrumentation>));
+	
+	auto& registry = VectorStatsRegistry::Instance();
+	{
+		SimpleVector<Plain, CountingInstrumentation> v;
+		for (int i = 0; i < 5; ++i) {
+			v.PushBack(Plain{i});
+		}
+		v.Reserve(100);
+		assert(v[4].value == 4);
+	}
+	const VectorStats& plain = registry.Get<Plain>();
+	assert(plain.element_size == sizeof(Plain));
+	// Ёмкости 1, 2, 4, 8 при росте и 100 после Reserve
+	assert(plain.allocations == 5);
+	assert(plain.deallocations == 5);
+	assert(plain.allocated_bytes == (1 + 2 + 4 + 8 + 100) * sizeof(Plain));
+	assert(plain.growth_events == 5);
+	assert(plain.moved_elements == 1 + 2 + 4 + 5);
+	assert(plain.copied_elements == 0);
+	assert(plain.relocated_bytes == plain.moved_elements * sizeof(Plain));
+	assert(plain.peak_capacity == 100);
+	{
+		SimpleVector<ThrowingMove, CountingInstrumentation> v;
+		for (int i = 0; i < 3; ++i) {
+			v.EmplaceBack(i);
+		}
+		v.Insert(v.cbegin(), ThrowingMove(-1));
+		assert(v[0].value == -1 && v[3].value == 2);
+	}
+	const VectorStats& throwing = registry.Get<ThrowingMove>();
+	assert(throwing.growth_events == 3);
+	assert(throwing.moved_elements == 0);
+	assert(throwing.copied_elements == 1 + 2);
+	assert(throwing.peak_capacity == 4);
+	assert(throwing.allocations == throwing.deallocations);
+	
+	std::ostringstream dump;
+	registry.Dump(dump);
+	assert(dump.str().find("Plain") != std::string::npos);
+	assert(dump.str().find("ThrowingMove") != std::string::npos);
+}
+
+void Test18() {
+	// Место создания не превращается в вектор, а вектор по-прежнему создаётся из {}
+	static_assert(!std::is_convertible_v<CallSite, SimpleVector<int>>);
+	static_assert(!std::is_convertible_v<CurrentCallSite, SimpleVector<int>>);
+	static_assert(!std::is_constructible_v<SimpleVector<int>, CallSite>);
+	{
+		struct Holder {
+			SimpleVector<int> v;
+		};
+		const Holder holder{};
+		SimpleVector<int> braced = {};
+		const auto make = []() -> SimpleVector<int> {
+			return {};
+		};
+		assert(holder.v.Size() == 0 && braced.Size() == 0 && make().Size() == 0);
+	}
+	auto& registry = CallSiteRegistry::Instance();
+	registry.Clear();
+	int loop_line = 0;
+	for (size_t i = 0; i < 100; ++i) {
+		loop_line = __LINE__ + 1;
+		SimpleVector<int, CallSiteProfiling> v;
+		const size_t size = i < 95 ? 100 : 1000;
+		for (size_t j = 0; j < size; ++j) {
+			v.PushBack(static_cast<int>(j));
+		}
+	}
+	int moved_line = 0;
+	{
+		// Размер перемещённого вектора засчитывается месту его создания, а вектор, созданный перемещением, не учитывается
+		moved_line = __LINE__ + 1;
+		SimpleVector<int, CallSiteProfiling> source;
+		source.Reserve(10);
+		for (int i = 0; i < 10; ++i) {
+			source.PushBack(i);
+		}
+		SimpleVector<int, CallSiteProfiling> target(std::move(source));
+		assert(target.Size() == 10);
+	}
+	
+	const auto recommendations = registry.Recommend(0.9);
+	const auto find = [&recommendations](int line) {
+		return std::find_if(recommendations.begin(), recommendations.end(), [line](const CapacityRecommendation& site) {
+			return site.line == line && site.file == __FILE__;
+		});
+	};
+	const auto loop = find(loop_line);
+	assert(loop != recommendations.end());
+	assert(loop->vectors == 100);
+	// Ёмкости 1, 2, ..., 128 для 100 элементов и 1, 2, ..., 1024 для 1000
+	assert(loop->growth_events == 95 * 8 + 5 * 11);
+	assert(loop->median_size == 100);
+	assert(loop->max_size == 1000);
+	assert(loop->reserve == 100);
+	// Reserve(100) и ещё 4 удвоения до 1600 для больших векторов
+	assert(loop->estimated_growth_events == 95 * 1 + 5 * 5);
+	const auto moved = find(moved_line);
+	assert(moved != recommendations.end());
+	assert(moved->vectors == 1);
+	assert(moved->growth_events == 1);
+	assert(moved->max_size == 10);
+	
+	std::ostringstream report;
+	registry.Report(report, 0.9);
+	assert(report.str().find(":" + std::to_string(loop_line) + ": vectors 100") != std::string::npos);
+	assert(report.str().find("Reserve(100)") != std::string::npos);
+}
+
+// Сравнивает счётчики целиком и при расхождении печатает оба набора со строкой проверки
+void AssertCounts(const LifecycleCounts& actual, const LifecycleCounts& expected, int line = __builtin_LINE()) {
+	if (actual != expected) {
+		std::cerr << "main.cpp:" << line << ": expected " << expected << ", got " << actual << std::endl;
+		std::abort();
+	}
+}
+
+// Вектор из size элементов со значениями 0, 1, ... и ёмкостью capacity. Счётчики обнуляются после заполнения
+template <typename Element>
+SimpleVector<Element> MakeCounted(size_t size, size_t capacity) {
+	SimpleVector<Element> v;
+	v.Reserve(capacity);
+	for (size_t i = 0; i < size; ++i) {
+		v.EmplaceBack(static_cast<int>(i));
+	}
+	Element::ResetCounts();
+	return v;
+}
+
+// Точное число операций над элементами для каждой операции вектора. Лишнее копирование
+// или перемещение в любой из них должно проваливать тест
+void Test19() {
+	using E = Counted<struct OperationCountsTag>;
+	using ThrowingE = Counted<struct ThrowingOperationCountsTag, false>;
+	const size_t SIZE = 8;
+	const int SIZE_INT = static_cast<int>(SIZE);
+	
+	// Конструирование, копирование, перемещение и уничтожение
+	{
+		E::ResetCounts();
+		SimpleVector<E> empty;
+		AssertCounts(E::Counts(), {});
+		SimpleVector<E> v(SIZE);
+		LifecycleCounts expected;
+		expected.default_constructed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		
+		E::ResetCounts();
+		SimpleVector<E> copy(v);
+		expected = {};
+		expected.copy_constructed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		
+		E::ResetCounts();
+		SimpleVector<E> moved(std::move(copy));
+		moved.Swap(v);
+		AssertCounts(E::Counts(), {});
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE);
 		{
-			cerr << "SimpleVector:"sv << endl;
-			C::Reset();
-			SimpleVector<C> v(NUM);
-			Dump();
-			v.PushBack(c);
+			auto moved = std::move(v);
 		}
-		Dump();
-	} catch (...) {
+		LifecycleCounts expected;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+	}
+	
+	// Присваивание
+	{
+		auto source = MakeCounted<E>(SIZE, SIZE);
+		auto v = MakeCounted<E>(3, 4);
+		v = source;
+		LifecycleCounts expected;
+		expected.copy_constructed = SIZE_INT;
+		expected.destroyed = 3;
+		AssertCounts(E::Counts(), expected);
+		
+		// Ёмкости хватает: общие элементы присваиваются, лишние уничтожаются или копируются
+		auto shorter = MakeCounted<E>(3, 3);
+		v = shorter;
+		expected = {};
+		expected.copy_assigned = 3;
+		expected.destroyed = SIZE_INT - 3;
+		AssertCounts(E::Counts(), expected);
+		
+		E::ResetCounts();
+		v = source;
+		expected = {};
+		expected.copy_assigned = 3;
+		expected.copy_constructed = SIZE_INT - 3;
+		AssertCounts(E::Counts(), expected);
+		
+		E::ResetCounts();
+		v = std::move(source);
+		AssertCounts(E::Counts(), {});
+	}
+	
+	// Добавление в конец: при свободной ёмкости конструируется только новый элемент,
+	// при росте старые элементы перемещаются или, если перемещение может бросить, копируются
+	{
+		const E value(-1);
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.PushBack(value);
+		LifecycleCounts expected;
+		expected.copy_constructed = 1;
+		AssertCounts(E::Counts(), expected);
+		
+		auto full = MakeCounted<E>(SIZE, SIZE);
+		full.PushBack(value);
+		expected = {};
+		expected.copy_constructed = 1;
+		expected.move_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.PushBack(E(-1));
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.move_constructed = 1;
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		
+		auto full = MakeCounted<E>(SIZE, SIZE);
+		full.PushBack(E(-1));
+		expected.move_constructed = 1 + SIZE_INT;
+		expected.destroyed = 1 + SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+	}
+	{
+		auto full = MakeCounted<ThrowingE>(SIZE, SIZE);
+		full.PushBack(ThrowingE(-1));
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.move_constructed = 1;
+		expected.copy_constructed = SIZE_INT;
+		expected.destroyed = 1 + SIZE_INT;
+		AssertCounts(ThrowingE::Counts(), expected);
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.EmplaceBack(-1);
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		AssertCounts(E::Counts(), expected);
+		
+		auto full = MakeCounted<E>(SIZE, SIZE);
+		full.EmplaceBack(-1);
+		expected.move_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		assert(full[SIZE].value == -1);
+	}
+	
+	// Вставка
+	{
+		const E value(-1);
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.Insert(v.cend(), value);
+		LifecycleCounts expected;
+		expected.copy_constructed = 1;
+		AssertCounts(E::Counts(), expected);
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.Emplace(v.cbegin() + 2, -1);
+		// Число не может ссылаться на сдвигаемые элементы, поэтому элемент создаётся сразу в промежутке
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.move_constructed = 1;
+		expected.move_assigned = SIZE_INT - 3;
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v[2].value == -1 && v[3].value == 2 && v[SIZE].value == SIZE_INT - 1);
+	}
+	{
+		const E value(-1);
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.Insert(v.cbegin() + 2, value);
+		// Готовый элемент вне вектора копируется сразу на освободившееся место
+		LifecycleCounts expected;
+		expected.copy_constructed = 1;
+		expected.move_constructed = 1;
+		expected.move_assigned = SIZE_INT - 3;
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v[2].value == -1 && v[3].value == 2 && v[SIZE].value == SIZE_INT - 1);
+	}
+	{
+		// Аргумент указывает внутрь сдвигаемого элемента
+		SimpleVector<std::string> v;
+		v.Reserve(10);
+		for (const char* s : {"a", "b", "c", "d", "e"}) {
+			v.PushBack(s);
+		}
+		v.Emplace(v.cbegin(), v[3].c_str());
+		assert(v[0] == "d" && v[4] == "d" && v[5] == "e");
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.Insert(v.cbegin() + 2, v[5]);
+		// Аргумент лежит в сдвигаемом хвосте, поэтому копия создаётся до сдвига
+		LifecycleCounts expected;
+		expected.copy_constructed = 1;
+		expected.move_constructed = 1;
+		expected.move_assigned = SIZE_INT - 2;
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v[2].value == 5 && v[3].value == 2 && v[5].value == 4 && v[6].value == 5);
+	}
+	{
+		auto v = MakeCounted<ThrowingE>(SIZE, SIZE * 2);
+		v.Emplace(v.cbegin() + 2, -1);
+		// Перемещение может бросить исключение: элемент создаётся во временном объекте
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.move_constructed = 1;
+		expected.move_assigned = SIZE_INT - 2;
+		expected.destroyed = 1;
+		AssertCounts(ThrowingE::Counts(), expected);
+		assert(v[2].value == -1 && v[3].value == 2);
+	}
+	{
+		SimpleVector<int> v;
+		v.Reserve(SIZE * 2);
+		for (int i = 0; i < SIZE_INT; ++i) {
+			v.PushBack(i);
+		}
+		v.Emplace(v.cbegin() + 2, -1);
+		v.Insert(v.cbegin(), v[SIZE]);
+		
+		// Вставка в пустой вектор без буфера
+		SimpleVector<int> empty;
+		empty.Insert(empty.cbegin(), 5);
+		assert(empty.Size() == 1 && empty[0] == 5);
+		assert(v[0] == SIZE_INT - 1 && v[1] == 0 && v[3] == -1 && v[4] == 2 && v[SIZE + 1] == SIZE_INT - 1);
+	}
+	{
+		// Исключение при создании элемента возвращает сдвинутый хвост на место
+		SimpleVector<Obj> v(SIZE);
+		v.Reserve(SIZE * 2);
+		for (size_t i = 0; i < SIZE; ++i) {
+			v[i].id = static_cast<int>(i);
+		}
+		Obj::default_construction_throw_countdown = 1;
+		try {
+			v.Emplace(v.cbegin() + 2);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(v.Size() == SIZE);
+		for (size_t i = 0; i < SIZE; ++i) {
+			assert(v[i].id == static_cast<int>(i));
+		}
+		assert(Obj::GetAliveObjectCount() == SIZE);
+	}
+	{
+		// Копирование готового элемента в промежуток бросает исключение, и хвост возвращается на место
+		SimpleVector<Obj> v(SIZE);
+		v.Reserve(SIZE * 2);
+		for (size_t i = 0; i < SIZE; ++i) {
+			v[i].id = static_cast<int>(i);
+		}
+		Obj throwing;
+		throwing.throw_on_copy = true;
+		try {
+			v.Insert(v.cbegin() + 2, throwing);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(v.Size() == SIZE);
+		for (size_t i = 0; i < SIZE; ++i) {
+			assert(v[i].id == static_cast<int>(i));
+		}
+	}
+	{
+		auto full = MakeCounted<E>(SIZE, SIZE);
+		full.Emplace(full.cbegin() + 2, -1);
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.move_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		assert(full[2].value == -1 && full[3].value == 2);
+	}
+	{
+		auto full = MakeCounted<ThrowingE>(SIZE, SIZE);
+		full.Emplace(full.cbegin() + 2, -1);
+		LifecycleCounts expected;
+		expected.value_constructed = 1;
+		expected.copy_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(ThrowingE::Counts(), expected);
+	}
+	{
+		// Некопируемые элементы перемещаются даже с бросающим перемещением, и исключение посреди
+		// переноса уничтожает уже перенесённые элементы по обе стороны от вставки
+		SimpleVector<MoveOnlyThrowing> full;
+		full.Reserve(SIZE);
+		for (size_t i = 0; i < SIZE; ++i) {
+			full.EmplaceBack(static_cast<int>(i));
+		}
+		const int alive = MoveOnlyThrowing::Alive();
+		// Первое перемещение создаёт вставляемый элемент, следующие переносят элементы 0, 1, ...
+		MoveOnlyThrowing::move_throw_countdown = 1 + 6;
+		try {
+			full.Emplace(full.cbegin() + 2, MoveOnlyThrowing(-1));
+			assert(false && "Exception is expected");
+		} catch (const std::runtime_error&) {
+		}
+		MoveOnlyThrowing::move_throw_countdown = 0;
+		assert(MoveOnlyThrowing::Alive() == alive);
+		assert(full.Size() == SIZE && full.Capacity() == SIZE);
+		full.Emplace(full.cbegin() + 2, MoveOnlyThrowing(-1));
+		assert(full[2].value == -1 && full[3].value == 2);
+	}
+	
+	// Копирующее присваивание с достаточной ёмкостью
+	{
+		const auto source = MakeCounted<E>(SIZE, SIZE);
+		auto target = MakeCounted<E>(SIZE / 2, SIZE * 2);
+		E::ResetCounts();
+		target = source;
+		LifecycleCounts expected;
+		expected.copy_assigned = SIZE_INT / 2;
+		expected.copy_constructed = SIZE_INT - SIZE_INT / 2;
+		AssertCounts(E::Counts(), expected);
+		assert(target.Size() == SIZE && target.Capacity() == SIZE * 2);
+		assert(target[0].value == 0 && target[SIZE - 1].value == SIZE_INT - 1);
+		
+		auto larger = MakeCounted<E>(SIZE * 2, SIZE * 2);
+		E::ResetCounts();
+		larger = source;
+		expected = {};
+		expected.copy_assigned = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		assert(larger.Size() == SIZE && larger[SIZE - 1].value == SIZE_INT - 1);
+	}
+	{
+		SimpleVector<int> source(5);
+		std::iota(source.begin(), source.end(), 1);
+		SimpleVector<int> target(8);
+		const int* data = &target[0];
+		target = source;
+		assert(target.Size() == 5 && &target[0] == data && target[4] == 5);
+		target = SimpleVector<int>();
+		source = target;
+		assert(source.Size() == 0 && source.Capacity() == 5);
+	}
+	
+	// Удаление
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE);
+		v.Erase(v.cbegin() + 2);
+		LifecycleCounts expected;
+		expected.move_assigned = SIZE_INT - 3;
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v[2].value == 3);
+		
+		E::ResetCounts();
+		v.PopBack();
+		expected = {};
+		expected.destroyed = 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v.Size() == SIZE - 2);
+		assert(v[0].value == 0 && v[SIZE - 3].value == SIZE_INT - 2);
+	}
+	
+	// Резервирование и изменение размера
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE);
+		v.Reserve(SIZE);
+		AssertCounts(E::Counts(), {});
+		v.Reserve(SIZE * 2);
+		LifecycleCounts expected;
+		expected.move_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(E::Counts(), expected);
+		
+		auto throwing = MakeCounted<ThrowingE>(SIZE, SIZE);
+		throwing.Reserve(SIZE * 2);
+		expected = {};
+		expected.copy_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT;
+		AssertCounts(ThrowingE::Counts(), expected);
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE * 2);
+		v.Resize(3);
+		LifecycleCounts expected;
+		expected.destroyed = SIZE_INT - 3;
+		AssertCounts(E::Counts(), expected);
+		
+		E::ResetCounts();
+		v.Resize(SIZE);
+		expected = {};
+		expected.default_constructed = SIZE_INT - 3;
+		AssertCounts(E::Counts(), expected);
+		// Уничтожается и создаётся хвост, а начало вектора не затрагивается
+		assert(v[0].value == 0 && v[2].value == 2 && v[3].value == 0 && v[SIZE - 1].value == 0);
+	}
+	{
+		auto v = MakeCounted<E>(SIZE, SIZE);
+		v.Resize(SIZE + 5, v[1]);
+		// Рост переносит элементы, а значение копируется до переноса
+		LifecycleCounts expected;
+		expected.copy_constructed = 6;
+		expected.move_constructed = SIZE_INT;
+		expected.destroyed = SIZE_INT + 1;
+		AssertCounts(E::Counts(), expected);
+		assert(v.Capacity() == SIZE + 5);
+		assert(v[0].value == 0 && v[SIZE - 1].value == SIZE_INT - 1 && v[SIZE].value == 1 && v[SIZE + 4].value == 1);
+		
+		E::ResetCounts();
+		v.Resize(SIZE + 2, E(7));
+		expected = {};
+		expected.value_constructed = 1;
+		expected.destroyed = 4;
+		AssertCounts(E::Counts(), expected);
+		assert(v[SIZE + 1].value == 1);
+	}
+	{
+		SimpleVector<int> v;
+		v.Resize(4, 9);
+		v.Resize(2);
+		v.Resize(6);
+		assert(v.Size() == 6 && v[1] == 9 && v[2] == 0 && v[5] == 0);
+		v.Resize(8, 3);
+		assert(v[5] == 0 && v[6] == 3 && v[7] == 3);
+	}
+	{
+		// Указатель на член внутри тривиальной структуры после value-инициализации нулевой
+		struct Holder {
+			int LifecycleCounts::*member;
+		};
+		SimpleVector<Holder> v;
+		v.Resize(1);
+		v[0].member = &LifecycleCounts::destroyed;
+		v.Resize(0);
+		v.Resize(3);
+		assert(v[0].member == nullptr && v[2].member == nullptr);
+		SimpleVector<int LifecycleCounts::*> members;
+		members.Resize(2);
+		assert(members[1] == nullptr);
+	}
+}
+
+void Test20() {
+	{
+		SimpleVector<int> empty;
+		const auto usage = empty.MemoryUsage();
+		assert(usage.used_bytes == 0 && usage.capacity_bytes == 0 && usage.allocated_bytes == 0);
+		assert(usage.slack_bytes == 0 && usage.overhead_bytes == 0);
+	}
+	{
+		SimpleVector<int> v;
+		v.Reserve(100);
+		for (int i = 0; i < 10; ++i) {
+			v.PushBack(i);
+		}
+		const auto usage = v.MemoryUsage();
+		assert(usage.used_bytes == 10 * sizeof(int));
+		assert(usage.capacity_bytes == 100 * sizeof(int));
+		assert(usage.slack_bytes == 90 * sizeof(int));
+		assert(usage.allocated_bytes >= usage.capacity_bytes);
+		assert(usage.overhead_bytes == usage.allocated_bytes - usage.capacity_bytes);
+	}
+	{
+		// Рекурсивный учёт: внешний буфер плюс буферы вложенных векторов
+		SimpleVector<SimpleVector<char>> nested(3);
+		size_t inner_capacity = 0;
+		for (size_t i = 0; i < nested.Size(); ++i) {
+			nested[i].Reserve(1000 * (i + 1));
+			nested[i].PushBack('x');
+			inner_capacity += nested[i].Capacity();
+		}
+		const auto shallow = nested.MemoryUsage();
+		const auto deep = nested.DeepMemoryUsage();
+		assert(shallow.capacity_bytes == 3 * sizeof(SimpleVector<char>));
+		assert(deep.capacity_bytes == shallow.capacity_bytes + inner_capacity);
+		assert(deep.used_bytes == shallow.used_bytes + 3);
+		assert(deep.slack_bytes == deep.capacity_bytes - deep.used_bytes);
+		
+		SimpleVector<SimpleVector<SimpleVector<char>>> twice;
+		twice.PushBack(nested);
+		assert(twice.DeepMemoryUsage().used_bytes == sizeof(nested) + deep.used_bytes);
+	}
+	{
+		// Счётчик процесса видит выделение и освобождение буфера вектора с учитывающей политикой,
+		// а векторы с политикой без инструментирования его не трогают
+		const size_t bytes_before = VectorMemoryCounter::AllocatedBytes();
+		const size_t buffers_before = VectorMemoryCounter::Buffers();
+		{
+			SimpleVector<char, NoInstrumentation> silent;
+			silent.Reserve(4096);
+			assert(VectorMemoryCounter::Buffers() == buffers_before);
+		}
+		{
+			SimpleVector<char, MemoryCountingInstrumentation> v;
+			v.Reserve(4096);
+			assert(VectorMemoryCounter::AllocatedBytes() == bytes_before + 4096);
+			assert(VectorMemoryCounter::Buffers() == buffers_before + 1);
+			v.Reserve(8192);
+			assert(VectorMemoryCounter::AllocatedBytes() == bytes_before + 8192);
+			assert(VectorMemoryCounter::Buffers() == buffers_before + 1);
+		}
+		assert(VectorMemoryCounter::AllocatedBytes() == bytes_before);
+		assert(VectorMemoryCounter::Buffers() == buffers_before);
+	}
+}
+
+void Test21() {
+	{
+		LatencyHistogram histogram;
+		assert(histogram.Count() == 0 && histogram.ValueAtPercentile(99) == 0);
+		for (uint64_t value = 1; value <= 1000; ++value) {
+			histogram.Record(value);
+		}
+		assert(histogram.Count() == 1000);
+		assert(histogram.Min() == 1 && histogram.Max() == 1000);
+		assert(histogram.Mean() == 500.5);
+		// Значения до SUB_BUCKET_COUNT точные, дальше погрешность не больше 2 / SUB_BUCKET_COUNT
+		assert(histogram.ValueAtPercentile(10) == 100);
+		const double tolerance = 2.0 / LatencyHistogram::SUB_BUCKET_COUNT;
+		for (const double percentile : {50.0, 90.0, 99.0, 99.9}) {
+			const auto exact = static_cast<double>(percentile * 10);
+			const auto value = static_cast<double>(histogram.ValueAtPercentile(percentile));
+			assert(value >= exact && value <= exact * (1 + tolerance));
+		}
+		assert(histogram.ValueAtPercentile(100) == 1000);
+		
+		LatencyHistogram slow;
+		slow.Record(1'000'000'000);
+		slow.Record(std::numeric_limits<uint64_t>::max());
+		histogram.Merge(slow);
+		assert(histogram.Count() == 1002);
+		assert(histogram.Max() == std::numeric_limits<uint64_t>::max());
+		const auto thousand = static_cast<double>(histogram.ValueAtPercentile(99.8));
+		assert(thousand >= 1000 && thousand <= 1000 * (1 + tolerance));
+		const auto billion = static_cast<double>(histogram.ValueAtPercentile(99.9));
+		assert(billion >= 1e9 && billion <= 1e9 * (1 + tolerance));
+		
+		histogram.Reset();
+		assert(histogram.Count() == 0 && histogram.Max() == 0 && histogram.Min() == 0);
+		{
+			ScopedLatency latency(histogram);
+		}
+		assert(histogram.Count() == 1);
+	}
+	{
+		// Рост в полтора раза: 1, 2, 3, 4, 6, 9, 13
+		SimpleVector<int, DefaultVectorInstrumentation, FactorGrowth<3, 2>> v;
+		for (int i = 0; i < 10; ++i) {
+			v.PushBack(i);
+		}
+		assert(v.Capacity() == 13);
+		assert(v[9] == 9);
+		v.EmplaceBack(10);
+		v.Insert(v.cbegin(), -1);
+		v.Insert(v.cbegin(), -2);
+		v.Insert(v.cbegin(), -3);
+		assert(v.Capacity() == 19);
+		assert(v.Size() == 14 && v[0] == -3 && v[13] == 10);
+		
+		SimpleVector<int> doubling;
+		for (int i = 0; i < 10; ++i) {
+			doubling.PushBack(i);
+		}
+		assert(doubling.Capacity() == 16);
+	}
+}
+
+void Test22() {
+	using E = Counted<struct IncrementalVectorTag>;
+	E::ResetCounts();
+	{
+		IncrementalVector<E> v;
+		const int SIZE = 10'000;
+		bool seen_migration = false;
+		for (int i = 0; i < SIZE; ++i) {
+			const size_t capacity = v.Capacity();
+			v.EmplaceBack(i);
+			if (v.Capacity() != capacity && capacity > IncrementalVector<E>::MIGRATION_STEP) {
+				// Сразу после роста большая часть элементов ещё в старом буфере
+				assert(v.IsMigrating());
+				seen_migration = true;
+			}
+			// Индекс ведёт в нужный буфер на любой стадии переноса
+			if (i % 97 == 0) {
+				for (int j = 0; j <= i; ++j) {
+					assert(v[j].value == j);
+				}
+			}
+		}
+		assert(seen_migration);
+		assert(v.Size() == SIZE);
+		assert(v.Capacity() == 16384);
+		// Каждый элемент переносится не больше одного раза на каждый рост и без копирования
+		assert(E::Counts().copy_constructed == 0);
+		assert(E::Counts().move_constructed < 2 * SIZE);
+		
+		// Ссылка на элемент старого буфера остаётся действительной во время роста
+		while (v.Size() != v.Capacity()) {
+			v.EmplaceBack(0);
+		}
+		v.PushBack(v[1]);
+		assert(v[v.Size() - 1].value == 1);
+		
+		// Удаление с конца во время переноса затрагивает оба буфера
+		assert(v.IsMigrating());
+		while (v.Size() > 100) {
+			v.PopBack();
+		}
+		for (int j = 0; j < 100; ++j) {
+			assert(v[j].value == j);
+		}
+		v.FinishMigration();
+		assert(!v.IsMigrating());
+		assert(v[0].value == 0 && v[99].value == 99);
+		
+		IncrementalVector<E> moved(std::move(v));
+		assert(moved.Size() == 100 && v.Size() == 0);
+		moved.FinishMigration();
+		assert(moved[99].value == 99);
+	}
+	assert(E::Counts().Alive() == 0);
+	{
+		IncrementalVector<std::string> strings;
+		for (int i = 0; i < 1000; ++i) {
+			strings.PushBack(std::to_string(i) + std::string(20, 'x'));
+		}
+		strings.FinishMigration();
+		assert(!strings.IsMigrating());
+		assert(strings[999] == "999" + std::string(20, 'x'));
+	}
+}
+
+void Test23() {
+	{
+		// Буфер, не выровненный по страницам, после отображения доступен целиком
+		RawMemory<int> memory(100'000);
+		memory.Prefault();
+		std::uninitialized_fill_n(memory.GetAddress(), memory.Capacity(), 7);
+		assert(memory[99'999] == 7);
+	}
+	using E = Counted<struct PreallocatingVectorTag>;
+	E::ResetCounts();
+	{
+		PreallocatingVector<E> v;
+		const int SIZE = 100'000;
+		bool seen_prepared = false;
+		for (int i = 0; i < SIZE; ++i) {
+			const size_t capacity = v.Capacity();
+			const size_t prepared = v.PreparedCapacity();
+			v.EmplaceBack(i);
+			if (v.Capacity() != capacity && prepared != 0) {
+				// Рост забрал подготовленный буфер
+				assert(v.Capacity() == prepared);
+				seen_prepared = true;
+			}
+			if (v.PreparedCapacity() != 0) {
+				assert(v.Size() * sizeof(E) >= PreallocatingVector<E>::MIN_PREALLOCATION_BYTES / 2);
+				assert(v.Size() >= v.Capacity() * 3 / 4);
+			}
+		}
+		assert(seen_prepared);
+		assert(v.Size() == SIZE);
+		for (int i = 0; i < SIZE; ++i) {
+			assert(v[i].value == i);
+		}
+		assert(E::Counts().copy_constructed == 0);
+		
+		// Ссылка на элемент остаётся действительной при росте в подготовленный буфер
+		while (v.Size() != v.Capacity()) {
+			v.EmplaceBack(0);
+		}
+		assert(v.PreparedCapacity() > v.Capacity());
+		v.PushBack(v[1]);
+		assert(v[v.Size() - 1].value == 1);
+		
+		// Reserve больше подготовленного буфера отбрасывает его
+		v.Reserve(v.Capacity() * 4);
+		assert(v.PreparedCapacity() == 0);
+		assert(v[SIZE - 1].value == SIZE - 1);
+	}
+	assert(E::Counts().Alive() == 0);
+	{
+		// Маленький вектор растёт без вспомогательного потока
+		PreallocatingVector<std::string> strings;
+		for (int i = 0; i < 100; ++i) {
+			strings.PushBack(std::to_string(i));
+			assert(strings.PreparedCapacity() == 0);
+		}
+		assert(strings[99] == "99");
+		assert(std::distance(strings.begin(), strings.end()) == 100);
+	}
+}
+
+void Test24() {
+	using E = Counted<struct PrefaultReserveTag>;
+	for (const ReserveMode mode : {ReserveMode::Lazy, ReserveMode::Prefault}) {
+		E::ResetCounts();
+		{
+			SimpleVector<E> v;
+			v.Reserve(10);
+			for (int i = 0; i < 10; ++i) {
+				v.EmplaceBack(i);
+			}
+			const LifecycleCounts before = E::Counts();
+			v.Reserve(100'000, mode);
+			assert(v.Capacity() == 100'000);
+			assert(v.Size() == 10);
+			for (int i = 0; i < 10; ++i) {
+				assert(v[i].value == i);
+			}
+			// Режим не меняет числа операций над элементами
+			LifecycleCounts expected = before;
+			expected.move_constructed += 10;
+			expected.destroyed += 10;
+			AssertCounts(E::Counts(), expected);
+			
+			// Ёмкости уже хватает: буфер не меняется, а элементы не затрагиваются
+			const E* data = &v[0];
+			v.Reserve(50'000, mode);
+			assert(&v[0] == data && v[9].value == 9);
+			AssertCounts(E::Counts(), expected);
+			while (v.Size() != v.Capacity()) {
+				v.EmplaceBack(static_cast<int>(v.Size()));
+			}
+			assert(v[99'999].value == 99'999);
+		}
+		assert(E::Counts().Alive() == 0);
+	}
+}
+
+void Test25() {
+	const size_t buffers = VectorMemoryCounter::Buffers();
+	{
+		using Memory = RawMemory<int, MemoryCountingInstrumentation>;
+		Memory source(1000);
+		int* const address = source.GetAddress();
+		Memory moved(std::move(source));
+		// Буфер не копируется, а переходит к новому владельцу
+		assert(moved.GetAddress() == address && moved.Capacity() == 1000);
+		assert(source.GetAddress() == nullptr && source.Capacity() == 0);
+		assert(VectorMemoryCounter::Buffers() == buffers + 1);
+		
+		// Присваивание освобождает прежний буфер получателя
+		Memory target(10);
+		assert(VectorMemoryCounter::Buffers() == buffers + 2);
+		target = std::move(moved);
+		assert(target.GetAddress() == address && moved.Capacity() == 0);
+		assert(VectorMemoryCounter::Buffers() == buffers + 1);
+		
+		Memory& self = target;
+		target = std::move(self);
+		assert(target.GetAddress() == address && target.Capacity() == 1000);
+		
+		// Пустой источник оставляет получателя пустым
+		target = std::move(source);
+		assert(target.GetAddress() == nullptr && target.Capacity() == 0);
+		assert(VectorMemoryCounter::Buffers() == buffers);
+	}
+	assert(VectorMemoryCounter::Buffers() == buffers);
+	
+	// Элементы в буфере не перемещаются: за ними следит владелец
+	using E = Counted<struct RawMemoryMoveTag>;
+	E::ResetCounts();
+	{
+		RawMemory<E> memory(4);
+		new(memory + 0) E(7);
+		RawMemory<E> moved(std::move(memory));
+		assert(moved[0].value == 7);
+		assert(E::Counts().move_constructed == 0 && E::Counts().copy_constructed == 0);
+		std::destroy_at(moved + 0);
 	}
+	assert(E::Counts().Alive() == 0);
 }
 
 int main() {
@@ -701,8 +2163,27 @@ int main() {
 		Test4();
 		Test5();
 		Test6();
-		Benchmark();
+		Test7();
+		Test8();
+		Test9();
+		Test10();
+		Test11();
+		Test12();
+		Test13();
+		Test14();
+		Test15();
+		Test16();
+		Test17();
+		Test18();
+		Test19();
+		Test20();
+		Test21();
+		Test22();
+		Test23();
+		Test24();
+		Test25();
 	} catch (const std::exception& e) {
 		std::cerr << e.what() << std::endl;
+		return 1;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,373 @@
+#pragma once
+#include "serialization.h"
+
+#include <cassert>
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class MapMode {
+	ReadOnly,   // Только чтение, страницы подгружаются ядром по требованию
+	ReadWrite,  // Изменения попадают в файл через общий (MAP_SHARED) маппинг
+};
+
+// Аналог RawMemory, хранящий элементы в файле формата Save/Load, отображённом в память.
+// Файл целиком отображается в адресное пространство: в начале лежит VectorFileHeader, за ним буфер
+template <typename T>
+class MappedMemory {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be stored in a file");
+	static_assert(alignof(T) <= sizeof(VectorFileHeader));
+
+public:
+	MappedMemory() = default;
+
+	MappedMemory(const std::string& path, MapMode mode)
+			: mode_(mode)
+	{
+		fd_ = ::open(path.c_str(), mode == MapMode::ReadOnly ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+		if (fd_ < 0) {
+			throw std::system_error(errno, std::generic_category(), "open " + path);
+		}
+		try {
+			struct stat st{};
+			if (::fstat(fd_, &st) != 0) {
+				throw std::system_error(errno, std::generic_category(), "fstat " + path);
+			}
+			size_t file_size = static_cast<size_t>(st.st_size);
+			const bool is_new = file_size == 0 && mode == MapMode::ReadWrite;
+			if (is_new) {
+				file_size = sizeof(VectorFileHeader);
+				Truncate(file_size);
+			}
+			if (file_size < sizeof(VectorFileHeader)) {
+				throw SerializationError("Not a SimpleVector file: " + path);
+			}
+			Map(file_size);
+			if (is_new) {
+				Header() = MakeVectorFileHeader<T>(nullptr, 0);
+			}
+			ValidateVectorFileHeader<T>(Header());
+		} catch (...) {
+			Close();
+			throw;
+		}
+	}
+
+	MappedMemory(const MappedMemory&) = delete;
+
+	MappedMemory& operator=(const MappedMemory& rhs) = delete;
+
+	~MappedMemory() {
+		Close();
+	}
+
+	T* operator+(size_t offset) noexcept {
+		assert(offset <= capacity_);
+		return GetAddress() + offset;
+	}
+
+	const T* operator+(size_t offset) const noexcept {
+		return const_cast<MappedMemory&>(*this) + offset;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<MappedMemory&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < capacity_);
+		return GetAddress()[index];
+	}
+
+	void Swap(MappedMemory& other) noexcept {
+		std::swap(fd_, other.fd_);
+		std::swap(mapping_, other.mapping_);
+		std::swap(mapping_size_, other.mapping_size_);
+		std::swap(capacity_, other.capacity_);
+		std::swap(mode_, other.mode_);
+	}
+
+	const T* GetAddress() const noexcept {
+		return const_cast<MappedMemory&>(*this).GetAddress();
+	}
+
+	T* GetAddress() noexcept {
+		return mapping_ == nullptr ? nullptr
+		                           : reinterpret_cast<T*>(static_cast<char*>(mapping_) + sizeof(VectorFileHeader));
+	}
+
+	size_t Capacity() const {
+		return capacity_;
+	}
+
+	MapMode Mode() const noexcept {
+		return mode_;
+	}
+
+	VectorFileHeader& Header() noexcept {
+		assert(mapping_ != nullptr);
+		return *static_cast<VectorFileHeader*>(mapping_);
+	}
+
+	const VectorFileHeader& Header() const noexcept {
+		return const_cast<MappedMemory&>(*this).Header();
+	}
+
+	// Увеличивает файл до new_capacity элементов и расширяет отображение. Адрес буфера может измениться
+	void Grow(size_t new_capacity) {
+		assert(mode_ == MapMode::ReadWrite);
+		if (new_capacity <= capacity_) {
+			return;
+		}
+		const size_t new_size = sizeof(VectorFileHeader) + new_capacity * sizeof(T);
+		Truncate(new_size);
+		void* new_mapping = ::mremap(mapping_, mapping_size_, new_size, MREMAP_MAYMOVE);
+		if (new_mapping == MAP_FAILED) {
+			throw std::system_error(errno, std::generic_category(), "mremap");
+		}
+		SetMapping(new_mapping, new_size);
+	}
+
+	// Сбрасывает изменённые страницы на диск
+	void Sync() {
+		if (mapping_ != nullptr && mode_ == MapMode::ReadWrite && ::msync(mapping_, mapping_size_, MS_SYNC) != 0) {
+			throw std::system_error(errno, std::generic_category(), "msync");
+		}
+	}
+
+private:
+	void Truncate(size_t size) {
+		if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+			throw std::system_error(errno, std::generic_category(), "ftruncate");
+		}
+	}
+
+	void Map(size_t size) {
+		const int protection = mode_ == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+		void* mapping = ::mmap(nullptr, size, protection, MAP_SHARED, fd_, 0);
+		if (mapping == MAP_FAILED) {
+			throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+		SetMapping(mapping, size);
+	}
+
+	void SetMapping(void* mapping, size_t size) noexcept {
+		mapping_ = mapping;
+		mapping_size_ = size;
+		capacity_ = (size - sizeof(VectorFileHeader)) / sizeof(T);
+	}
+
+	void Close() noexcept {
+		if (mapping_ != nullptr) {
+			::munmap(mapping_, mapping_size_);
+			mapping_ = nullptr;
+		}
+		if (fd_ >= 0) {
+			::close(fd_);
+			fd_ = -1;
+		}
+		mapping_size_ = 0;
+		capacity_ = 0;
+	}
+
+	int fd_ = -1;
+	void* mapping_ = nullptr;
+	size_t mapping_size_ = 0;
+	size_t capacity_ = 0;
+	MapMode mode_ = MapMode::ReadOnly;
+};
+
+
+
+// Вектор тривиально копируемых элементов, хранящийся в файле. Открытие файла выполняется за O(1):
+// данные не читаются, а подгружаются ядром по мере обращения к страницам.
+// Размер хранится в заголовке файла. Контрольная сумма пересчитывается и изменения сбрасываются
+// на диск явным вызовом Sync или Close. Деструктор только обновляет контрольную сумму, и лишь если
+// вектор изменялся, поэтому файл, закрытый штатно, читается и обычной функцией Load, а закрытие
+// неизменённого отображения не читает файл. Любой неконстантный доступ к элементам считается
+// изменением, поэтому читать лучше через константную ссылку.
+// MappedVector<const T> отображает файл только для чтения и даёт лишь константный доступ к элементам,
+// поэтому запись в такое отображение не компилируется
+template <typename T>
+class MappedVector {
+	using Element = std::remove_const_t<T>;
+	static constexpr bool IS_READ_ONLY = std::is_const_v<T>;
+
+public:
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	iterator begin() noexcept {
+		MarkDirty();
+		return data_.GetAddress();
+	}
+	iterator end() noexcept {
+		MarkDirty();
+		return data_ + Size();
+	}
+	const_iterator begin() const noexcept {
+		return data_.GetAddress();
+	}
+	const_iterator end() const noexcept {
+		return data_ + Size();
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	MappedVector() noexcept = default;
+
+	// Открывает файл формата Save. MappedVector<T> создаёт его, если файла нет
+	explicit MappedVector(const std::string& path)
+			: data_(path, IS_READ_ONLY ? MapMode::ReadOnly : MapMode::ReadWrite)
+	{
+		if (data_.Header().count > data_.Capacity()) {
+			throw SerializationError("SimpleVector file is truncated: " + path);
+		}
+	}
+
+	MappedVector(const MappedVector&) = delete;
+
+	MappedVector& operator=(const MappedVector&) = delete;
+
+	MappedVector(MappedVector&& other) noexcept {
+		Swap(other);
+	}
+
+	MappedVector& operator=(MappedVector&& rhs) noexcept {
+		if (this != &rhs) {
+			Swap(rhs);
+		}
+		return *this;
+	}
+
+	~MappedVector() {
+		// Без msync: страницы общего отображения ядро запишет само, а ждать записи на диск
+		// должен только тот, кто вызвал Sync или Close
+		if (is_dirty_) {
+			UpdateChecksum();
+		}
+	}
+
+	size_t Size() const noexcept {
+		return data_.GetAddress() == nullptr ? 0 : static_cast<size_t>(data_.Header().count);
+	}
+
+	size_t Capacity() const noexcept {
+		return data_.Capacity();
+	}
+
+	static constexpr bool IsWritable() noexcept {
+		return !IS_READ_ONLY;
+	}
+
+	// Изменялся ли вектор после открытия или последнего Sync
+	bool IsDirty() const noexcept {
+		return is_dirty_;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		assert(index < Size());
+		return data_[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < Size());
+		MarkDirty();
+		return data_[index];
+	}
+
+	void Swap(MappedVector& other) noexcept {
+		data_.Swap(other.data_);
+		std::swap(is_dirty_, other.is_dirty_);
+	}
+
+	// Увеличение файла не меняет содержимого, поэтому не делает вектор изменённым
+	void Reserve(size_t new_capacity) {
+		static_assert(!IS_READ_ONLY, "Read-only MappedVector can't be modified");
+		data_.Grow(new_capacity);
+	}
+
+	void Resize(size_t new_size) {
+		Reserve(new_size);
+		for (size_t i = Size(); i < new_size; ++i) {
+			data_[i] = Element{};
+		}
+		SetSize(new_size);
+	}
+
+	void PushBack(const Element& value) {
+		const size_t size = Size();
+		if (size == Capacity()) {
+			// value может ссылаться на элемент вектора, а mremap переносит отображение
+			const Element copy = value;
+			Reserve(size == 0 ? 1 : size * 2);
+			data_[size] = copy;
+		} else {
+			data_[size] = value;
+		}
+		SetSize(size + 1);
+	}
+
+	void PopBack() {
+		assert(Size() > 0);
+		SetSize(Size() - 1);
+	}
+
+	// Записывает контрольную сумму в заголовок и сбрасывает изменения на диск.
+	// Для неизменённого вектора ничего не делает
+	void Sync() {
+		if (is_dirty_) {
+			UpdateChecksum();
+			data_.Sync();
+			is_dirty_ = false;
+		}
+	}
+
+	// Сбрасывает изменения на диск и закрывает файл. После этого вектор пуст
+	void Close() {
+		Sync();
+		MappedVector closed;
+		Swap(closed);
+	}
+
+	// Сверяет содержимое с контрольной суммой из заголовка. Требует чтения всего файла
+	bool VerifyChecksum() const noexcept {
+		if (data_.GetAddress() == nullptr) {
+			return true;
+		}
+		return ComputeChecksum(begin(), Size() * sizeof(T)) == data_.Header().checksum;
+	}
+
+private:
+	void SetSize(size_t size) noexcept {
+		static_assert(!IS_READ_ONLY, "Read-only MappedVector can't be modified");
+		data_.Header().count = size;
+		is_dirty_ = true;
+	}
+
+	void MarkDirty() noexcept {
+		if constexpr (!IS_READ_ONLY) {
+			is_dirty_ = true;
+		}
+	}
+
+	void UpdateChecksum() noexcept {
+		if (data_.GetAddress() != nullptr && !IS_READ_ONLY) {
+			data_.Header().checksum = ComputeChecksum(data_.GetAddress(), Size() * sizeof(T));
+		}
+	}
+
+	MappedMemory<Element> data_;
+	bool is_dirty_ = false;
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Аппаратные счётчики, собираемые вокруг каждого прогона бенчмарка
+enum class PerfCounter {
+	Cycles,
+	Instructions,
+	CacheMisses,
+	BranchMisses,
+	DtlbMisses,
+};
+
+inline constexpr size_t PERF_COUNTER_COUNT = 5;
+
+inline constexpr std::array<std::string_view, PERF_COUNTER_COUNT> PERF_COUNTER_NAMES = {
+		"cycles", "instructions", "cache-misses", "branch-misses", "dTLB-misses",
+};
+
+// Значения счётчиков за один замер. Значение отсутствует, если счётчик не удалось открыть
+struct PerfSample {
+	std::array<double, PERF_COUNTER_COUNT> values{};
+	std::array<bool, PERF_COUNTER_COUNT> valid{};
+};
+
+// Набор счётчиков perf_event_open текущего потока, считающих только пользовательский код.
+// Каждый счётчик открывается отдельно: если ядро или окружение (perf_event_paranoid, виртуальная
+// машина без PMU, seccomp) запрещает часть событий, остальные продолжают работать. При вытеснении
+// счётчиков мультиплексированием значение масштабируется на долю времени, когда счётчик был активен.
+// На системах без perf_event_open все счётчики недоступны
+class PerfCounters {
+public:
+	PerfCounters() {
+		fds_.fill(-1);
+#if defined(__linux__)
+		for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			SetEvent(static_cast<PerfCounter>(i), attr);
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			if (fds_[i] < 0 && error_.empty()) {
+				error_ = std::string(PERF_COUNTER_NAMES[i]) + ": " + std::strerror(errno);
+			}
+		}
+#else
+		error_ = "perf_event_open is not supported on this platform";
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	~PerfCounters() {
+#if defined(__linux__)
+		for (const int fd : fds_) {
+			if (fd >= 0) {
+				::close(fd);
+			}
+		}
+#endif
+	}
+
+	bool IsAvailable(PerfCounter counter) const noexcept {
+		return fds_[static_cast<size_t>(counter)] >= 0;
+	}
+
+	bool IsAnyAvailable() const noexcept {
+		for (const int fd : fds_) {
+			if (fd >= 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Причина, по которой первый из недоступных счётчиков не открылся, или пустая строка
+	const std::string& Error() const noexcept {
+		return error_;
+	}
+
+	// Обнуляет и запускает все доступные счётчики
+	void Start() noexcept {
+#if defined(__linux__)
+		for (const int fd : fds_) {
+			if (fd >= 0) {
+				::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	// Останавливает счётчики и возвращает накопленные с момента Start значения
+	PerfSample Stop() noexcept {
+		PerfSample sample;
+#if defined(__linux__)
+		for (const int fd : fds_) {
+			if (fd >= 0) {
+				::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+		for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+			if (fds_[i] < 0) {
+				continue;
+			}
+			uint64_t data[3];  // Значение, время включения, время работы
+			if (::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+				continue;
+			}
+			sample.values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+			sample.valid[i] = true;
+		}
+#endif
+		return sample;
+	}
+
+private:
+#if defined(__linux__)
+	static void SetEvent(PerfCounter counter, perf_event_attr& attr) noexcept {
+		switch (counter) {
+			case PerfCounter::Cycles:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case PerfCounter::Instructions:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case PerfCounter::CacheMisses:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CACHE_MISSES;
+				break;
+			case PerfCounter::BranchMisses:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case PerfCounter::DtlbMisses:
+				attr.type = PERF_TYPE_HW_CACHE;
+				attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+				              | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+		}
+	}
+#endif
+
+	std::array<int, PERF_COUNTER_COUNT> fds_;
+	std::string error_;
+};
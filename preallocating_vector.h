@@ -0,0 +1,176 @@
+#pragma once
+#include "simple_vector.h"
+
+#include <cassert>
+#include <future>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+// Вектор, готовящий следующий буфер заранее. Когда размер достигает доли high_water от ёмкости,
+// следующий буфер выделяется, а его страницы отображаются в память вспомогательным потоком,
+// пока вектор продолжает заполняться. Рост при заполнении буфера тогда только переносит элементы
+// в уже «тёплую» память, без page fault на каждой новой странице. Буферы меньше
+// MIN_PREALLOCATION_BYTES растут как обычно: для них запуск потока дороже самого роста
+template <typename T>
+class PreallocatingVector {
+public:
+	static constexpr size_t MIN_PREALLOCATION_BYTES = size_t{1} << 16;
+	static constexpr double DEFAULT_HIGH_WATER = 0.75;
+
+	explicit PreallocatingVector(double high_water = DEFAULT_HIGH_WATER) noexcept
+			: high_water_(high_water) {
+		assert(high_water > 0 && high_water <= 1);
+	}
+
+	PreallocatingVector(const PreallocatingVector&) = delete;
+	PreallocatingVector& operator=(const PreallocatingVector&) = delete;
+
+	~PreallocatingVector() {
+		// Поток подготовки пишет в next_, поэтому буфер освобождается только после его завершения
+		WaitForPrefault();
+		std::destroy_n(data_.GetAddress(), size_);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return data_.Capacity();
+	}
+
+	// Ёмкость подготовленного следующего буфера или 0, если он ещё не выделен
+	size_t PreparedCapacity() const noexcept {
+		return next_.Capacity();
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		assert(index < size_);
+		return data_[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return data_[index];
+	}
+
+	T* begin() noexcept {
+		return data_.GetAddress();
+	}
+
+	T* end() noexcept {
+		return data_ + size_;
+	}
+
+	const T* begin() const noexcept {
+		return data_.GetAddress();
+	}
+
+	const T* end() const noexcept {
+		return data_ + size_;
+	}
+
+	void Reserve(size_t new_capacity) {
+		if (new_capacity <= data_.Capacity()) {
+			return;
+		}
+		// Подготовленный буфер меньше запрошенного не пригодится
+		DropPrepared();
+		RawMemory<T> new_data(new_capacity);
+		Relocate(new_data);
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		T* slot;
+		if (size_ == data_.Capacity()) {
+			RawMemory<T> new_data = TakeNextBuffer();
+			// Новый элемент создаётся до переноса, пока аргументы, ссылающиеся на элементы вектора, живы
+			slot = new(new_data + size_) T(std::forward<Args>(args)...);
+			try {
+				Relocate(new_data);
+			}
+			catch (...) {
+				std::destroy_at(slot);
+				throw;
+			}
+		}
+		else {
+			slot = new(data_ + size_) T(std::forward<Args>(args)...);
+		}
+		++size_;
+		PrepareNextIfNeeded();
+		return *slot;
+	}
+
+private:
+	// Буфер для роста: подготовленный, если он есть, иначе выделенный сейчас
+	RawMemory<T> TakeNextBuffer() {
+		WaitForPrefault();
+		if (next_.Capacity() > size_) {
+			return std::move(next_);
+		}
+		DropPrepared();
+		return RawMemory<T>(DoublingGrowth::NextCapacity(size_));
+	}
+
+	void PrepareNextIfNeeded() {
+		if (next_.Capacity() != 0 || data_.Capacity() * sizeof(T) < MIN_PREALLOCATION_BYTES
+		    || static_cast<double>(size_) < high_water_ * static_cast<double>(data_.Capacity())) {
+			return;
+		}
+		// Выделение большого блока лишь резервирует адреса и дёшево, дорого первое касание страниц
+		next_ = RawMemory<T>(DoublingGrowth::NextCapacity(data_.Capacity()));
+		void* buffer = next_.GetAddress();
+		const size_t bytes = next_.Capacity() * sizeof(T);
+		try {
+			prefault_ = std::async(std::launch::async, [buffer, bytes] {
+				PrefaultPages(buffer, bytes);
+			});
+		}
+		catch (const std::system_error&) {
+			// Поток не запустился: буфер всё равно пригодится, страницы отобразятся при переносе
+		}
+	}
+
+	void WaitForPrefault() noexcept {
+		if (prefault_.valid()) {
+			prefault_.wait();
+			prefault_ = {};
+		}
+	}
+
+	void DropPrepared() noexcept {
+		WaitForPrefault();
+		next_ = RawMemory<T>();
+	}
+
+	// Переносит элементы в new_data и делает его текущим буфером
+	void Relocate(RawMemory<T>& new_data) {
+		if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+			std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+		}
+		else {
+			std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+		}
+		std::destroy_n(data_.GetAddress(), size_);
+		data_.Swap(new_data);
+	}
+
+	RawMemory<T> data_;
+	RawMemory<T> next_;  // Следующий буфер, пока ещё пустой
+	std::future<void> prefault_;  // Отображение страниц next_ во вспомогательном потоке
+	size_t size_ = 0;
+	double high_water_;
+};
@@ -0,0 +1,184 @@
+#pragma once
+#include "simple_vector.h"
+#include "vector_view.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+class SerializationError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Заголовок двоичного файла с содержимым SimpleVector. Сразу за ним следуют count элементов
+// в том виде, в каком они лежат в памяти. Размер заголовка кратен любому разумному выравниванию,
+// поэтому данные в файле выровнены так же, как в буфере RawMemory
+struct VectorFileHeader {
+	static constexpr char MAGIC[4] = {'S', 'V', 'E', 'C'};
+	static constexpr uint16_t VERSION = 1;
+	// Записывается в порядке байтов машины; на машине с другим порядком читается как 0x0201
+	static constexpr uint16_t BYTE_ORDER_MARK = 0x0102;
+
+	char magic[4];
+	uint16_t version;
+	uint16_t byte_order;
+	uint32_t element_size;
+	uint32_t element_alignment;
+	uint64_t count;
+	uint64_t checksum;
+	uint8_t reserved[32];
+};
+
+static_assert(sizeof(VectorFileHeader) == 64);
+
+// Контрольная сумма блока памяти. Обрабатывает данные словами по 8 байт, чтобы проверка
+// многогигабайтных буферов не становилась узким местом загрузки
+inline uint64_t ComputeChecksum(const void* data, size_t size) noexcept {
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+	size_t offset = 0;
+	for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, bytes + offset, sizeof(word));
+		hash = (hash ^ word) * 0x100000001b3ULL;
+		hash ^= hash >> 29;
+	}
+	for (; offset < size; ++offset) {
+		hash = (hash ^ bytes[offset]) * 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+template <typename T>
+VectorFileHeader MakeVectorFileHeader(const T* data, size_t count) noexcept {
+	VectorFileHeader header{};
+	std::memcpy(header.magic, VectorFileHeader::MAGIC, sizeof(header.magic));
+	header.version = VectorFileHeader::VERSION;
+	header.byte_order = VectorFileHeader::BYTE_ORDER_MARK;
+	header.element_size = sizeof(T);
+	header.element_alignment = alignof(T);
+	header.count = count;
+	header.checksum = ComputeChecksum(data, count * sizeof(T));
+	return header;
+}
+
+// Проверяет, что заголовок описывает массив элементов типа T, записанный на совместимой машине
+template <typename T>
+void ValidateVectorFileHeader(const VectorFileHeader& header) {
+	if (std::memcmp(header.magic, VectorFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+		throw SerializationError("Not a SimpleVector file");
+	}
+	if (header.version != VectorFileHeader::VERSION) {
+		throw SerializationError("Unsupported SimpleVector file version");
+	}
+	if (header.byte_order != VectorFileHeader::BYTE_ORDER_MARK) {
+		throw SerializationError("SimpleVector file has foreign byte order");
+	}
+	if (header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+		throw SerializationError("SimpleVector file element type mismatch");
+	}
+	if (header.count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+		throw SerializationError("SimpleVector file is too large");
+	}
+}
+
+// Проверяет, что после заголовка осталось не меньше байт, чем в нём объявлено. Иначе повреждённое
+// поле count привело бы к выделению огромного буфера раньше, чем обнаружится нехватка данных
+template <typename T>
+void ValidateVectorPayloadSize(const VectorFileHeader& header, uint64_t available_bytes) {
+	if (header.count > available_bytes / sizeof(T)) {
+		throw SerializationError("SimpleVector file is truncated");
+	}
+}
+
+namespace detail {
+
+	// Сколько байт осталось в потоке до конца или -1, если поток не поддерживает позиционирование
+	inline std::streamoff RemainingBytes(std::istream& in) {
+		const std::istream::pos_type position = in.tellg();
+		if (position == std::istream::pos_type(-1)) {
+			in.clear();
+			return -1;
+		}
+		in.seekg(0, std::ios::end);
+		const std::istream::pos_type end = in.tellg();
+		in.seekg(position);
+		if (!in || end == std::istream::pos_type(-1)) {
+			in.clear();
+			in.seekg(position);
+			return -1;
+		}
+		return end - position;
+	}
+
+}  // namespace detail
+
+// Записывает заголовок и содержимое буфера одной операцией записи. Элементы прорежённого представления
+// сначала собираются в непрерывный буфер: в файл попадают только они, а не промежутки между ними
+template <typename T>
+void Save(std::ostream& out, VectorView<T> view) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be saved as raw bytes");
+	if (!view.IsContiguous()) {
+		SimpleVector<T> gathered;
+		std::copy(view.begin(), view.end(), gathered.AppendUninitialized(view.Size()));
+		Save(out, VectorView<T>(gathered));
+		return;
+	}
+	const VectorFileHeader header = MakeVectorFileHeader(view.Data(), view.Size());
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(view.Data()), static_cast<std::streamsize>(view.Size() * sizeof(T)));
+	if (!out) {
+		throw SerializationError("Failed to write SimpleVector");
+	}
+}
+
+template <typename T>
+void Save(std::ostream& out, const SimpleVector<T>& vector) {
+	Save(out, VectorView<T>(vector));
+}
+
+// Читает содержимое одной операцией чтения прямо в неинициализированный буфер вектора.
+// Если длину потока узнать нельзя (канал, сокет), читает частями по LOAD_CHUNK_BYTES, и буфер растёт
+// только по мере поступления данных
+inline constexpr size_t LOAD_CHUNK_BYTES = size_t{1} << 20;
+
+template <typename T>
+SimpleVector<T> Load(std::istream& in) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be loaded from raw bytes");
+	VectorFileHeader header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		throw SerializationError("Failed to read SimpleVector header");
+	}
+	ValidateVectorFileHeader<T>(header);
+
+	SimpleVector<T> result;
+	const size_t count = static_cast<size_t>(header.count);
+	const std::streamoff remaining = detail::RemainingBytes(in);
+	if (remaining >= 0) {
+		ValidateVectorPayloadSize<T>(header, static_cast<uint64_t>(remaining));
+		T* data = result.AppendUninitialized(count);
+		if (!in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * sizeof(T)))) {
+			throw SerializationError("SimpleVector file is truncated");
+		}
+	} else {
+		const size_t chunk = std::max<size_t>(1, LOAD_CHUNK_BYTES / sizeof(T));
+		while (result.Size() < count) {
+			const size_t part = std::min(chunk, count - result.Size());
+			T* data = result.AppendUninitialized(part);
+			if (!in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(part * sizeof(T)))) {
+				throw SerializationError("SimpleVector file is truncated");
+			}
+		}
+	}
+	const T* data = result.begin();
+	if (ComputeChecksum(data, count * sizeof(T)) != header.checksum) {
+		throw SerializationError("SimpleVector file checksum mismatch");
+	}
+	return result;
+}
@@ -5,8 +5,75 @@
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 
-template <typename T>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "vector_instrumentation.h"
+
+// Память, занятая буферами векторов
+struct VectorMemoryUsage {
+	size_t used_bytes = 0;  // Под элементы: размер * sizeof(T)
+	size_t capacity_bytes = 0;  // Под весь буфер: ёмкость * sizeof(T)
+	size_t slack_bytes = 0;  // Зарезервировано, но не занято элементами
+	size_t allocated_bytes = 0;  // Фактически выделено аллокатором, не меньше capacity_bytes
+	size_t overhead_bytes = 0;  // Округление аллокатора сверх capacity_bytes
+	
+	VectorMemoryUsage& operator+=(const VectorMemoryUsage& other) noexcept {
+		used_bytes += other.used_bytes;
+		capacity_bytes += other.capacity_bytes;
+		slack_bytes += other.slack_bytes;
+		allocated_bytes += other.allocated_bytes;
+		overhead_bytes += other.overhead_bytes;
+		return *this;
+	}
+};
+
+// Заставляет ядро заранее выделить физические страницы под [data, data + bytes), чтобы первая запись
+// в них не прерывалась page fault. Содержимое памяти может быть перезаписано нулями
+inline void PrefaultPages(void* data, size_t bytes) noexcept {
+	if (bytes == 0) {
+		return;
+	}
+	auto* first = static_cast<char*>(data);
+#if defined(__unix__)
+	const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#else
+	const size_t page = 4096;
+#endif
+#if defined(MADV_POPULATE_WRITE)
+	// Ядро отображает все страницы диапазона за один вызов и не меняет их содержимое
+	const auto begin = reinterpret_cast<uintptr_t>(first) & ~(uintptr_t{page} - 1);
+	const auto end = reinterpret_cast<uintptr_t>(first + bytes);
+	if (::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_POPULATE_WRITE) == 0) {
+		return;
+	}
+#endif
+	// Ядра без MADV_POPULATE_WRITE: по одной записи на каждую страницу
+	for (size_t offset = 0; offset < bytes; offset += page) {
+		*static_cast<volatile char*>(first + offset) = 0;
+	}
+	*static_cast<volatile char*>(first + bytes - 1) = 0;
+}
+
+// Отображать ли страницы буфера в память при резервировании или при первой записи
+enum class ReserveMode {
+	Lazy,
+	Prefault,
+};
+
+template <typename T, typename Instrumentation = DefaultVectorInstrumentation>
 class RawMemory {
 public:
 	RawMemory() = default;
@@ -20,20 +87,25 @@ public:
 	
 	RawMemory& operator=(const RawMemory& rhs) = delete;
 	
+	// Перемещение забирает буфер целиком и оставляет источник пустым. Элементы в буфере
+	// не затрагиваются, поэтому оно не зависит от ёмкости
 	RawMemory(RawMemory&& other) noexcept
-			: capacity_(other.capacity_)
-	{
-		std::uninitialized_move_n(other.buffer_, capacity_, buffer_);
+			: buffer_(std::exchange(other.buffer_, nullptr))
+			, capacity_(std::exchange(other.capacity_, 0)) {
 	}
 	
+	// Собственный буфер освобождается. Живые элементы в нём должен уничтожить владелец
 	RawMemory& operator=(RawMemory&& rhs) noexcept {
-		capacity_ = rhs.capacity_;
-		std::uninitialized_move_n(rhs.buffer_, capacity_, buffer_);
+		if (this != &rhs) {
+			Deallocate(buffer_, capacity_);
+			buffer_ = std::exchange(rhs.buffer_, nullptr);
+			capacity_ = std::exchange(rhs.capacity_, 0);
+		}
 		return *this;
 	}
 	
 	~RawMemory() {
-		Deallocate(buffer_);
+		Deallocate(buffer_, capacity_);
 	}
 	
 	T* operator+(size_t offset) noexcept {
@@ -71,15 +143,42 @@ public:
 	size_t Capacity() const {
 		return capacity_;
 	}
+	
+	// Заранее отображает страницы буфера в память. Допустимо, только пока в буфере нет элементов
+	void Prefault() noexcept {
+		PrefaultPages(buffer_, capacity_ * sizeof(T));
+	}
+	
+	// Сколько байт аллокатор фактически выделил под буфер. Без glibc округление неизвестно,
+	// и возвращается запрошенный размер
+	size_t AllocatedBytes() const noexcept {
+		if (buffer_ == nullptr) {
+			return 0;
+		}
+#if defined(__GLIBC__)
+		// operator new по умолчанию выделяет память через malloc
+		return malloc_usable_size(buffer_);
+#else
+		return capacity_ * sizeof(T);
+#endif
+	}
 
 private:
 	// Выделяет сырую память под n элементов и возвращает указатель на неё
 	static T* Allocate(size_t n) {
-		return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+		if (n == 0) {
+			return nullptr;
+		}
+		T* buf = static_cast<T*>(operator new(n * sizeof(T)));
+		Instrumentation::template OnAllocate<T>(n);
+		return buf;
 	}
 	
-	// Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-	static void Deallocate(T* buf) noexcept {
+	// Освобождает сырую память на capacity элементов, выделенную ранее по адресу buf при помощи Allocate
+	static void Deallocate(T* buf, size_t capacity) noexcept {
+		if (buf != nullptr) {
+			Instrumentation::template OnDeallocate<T>(capacity);
+		}
 		operator delete(buf);
 	}
 	
@@ -89,8 +188,25 @@ private:
 
 
 
-template <typename T>
-class SimpleVector {
+// Политика роста: ёмкость буфера, который заменяет заполненный буфер из size элементов,
+// — в Numerator / Denominator раз больше, но не меньше size + 1
+template <size_t Numerator, size_t Denominator>
+struct FactorGrowth {
+	static_assert(Numerator > Denominator, "Growth factor must be greater than 1");
+	
+	static size_t NextCapacity(size_t size) noexcept {
+		return std::max(size + 1, size / Denominator * Numerator + size % Denominator * Numerator / Denominator);
+	}
+};
+
+using DoublingGrowth = FactorGrowth<2, 1>;
+
+// Вектор с политикой инструментирования Instrumentation (см. vector_instrumentation.h),
+// которая получает уведомления о выделениях памяти, росте буфера и переносе элементов,
+// и политикой роста Growth, которая выбирает ёмкость нового буфера при заполнении текущего.
+// Конструкторы по умолчанию и с размером запоминают место вызова для CallSiteProfiling
+template <typename T, typename Instrumentation = DefaultVectorInstrumentation, typename Growth = DoublingGrowth>
+class SimpleVector : private Instrumentation {
 public:
 	
 	using iterator = T*;
@@ -115,13 +231,16 @@ public:
 		return data_ + size_;
 	}
 	
-	SimpleVector() noexcept = default;
+	SimpleVector(CurrentCallSite site = CallSite::Current()) noexcept {
+		Instrumentation::OnConstruct(site);
+	}
 	
-	explicit SimpleVector(size_t size)
+	explicit SimpleVector(size_t size, CurrentCallSite site = CallSite::Current())
 			: data_(size)
 			, size_(size)
 	{
 		std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+		Instrumentation::OnConstruct(site);
 	}
 	
 	SimpleVector(const SimpleVector& other)
@@ -138,20 +257,22 @@ public:
 	SimpleVector& operator=(const SimpleVector& rhs) {
 		if (this != &rhs) {
 			if (rhs.size_ > data_.Capacity()) {
-				SimpleVector<T> rhs_copy = rhs;
+				SimpleVector rhs_copy = rhs;
 				Swap(rhs_copy);
 			} else {
-				if(size_ > rhs.size_) {
-					std::destroy_n(data_.GetAddress(), size_ - rhs.size_);
-					for(size_t i = 0; i < rhs.size_; ++i) {
-						data_[i] = rhs.data_[i];
+				// Ёмкости хватает: общее начало присваивается, а хвост создаётся или уничтожается
+				if constexpr (std::is_trivially_copyable_v<T>) {
+					if (rhs.size_ != 0) {
+						std::memcpy(static_cast<void*>(data_.GetAddress()), rhs.data_.GetAddress(), rhs.size_ * sizeof(T));
 					}
 				}
+				else if(size_ > rhs.size_) {
+					std::copy_n(rhs.data_.GetAddress(), rhs.size_, data_.GetAddress());
+					std::destroy_n(data_ + rhs.size_, size_ - rhs.size_);
+				}
 				else {
-					for(size_t i = 0; i < size_; ++i) {
-						data_[i] = rhs.data_[i];
-					}
-					std::uninitialized_copy_n(rhs.data_.GetAddress(), rhs.size_ - size_, data_.GetAddress());
+					std::copy_n(rhs.data_.GetAddress(), size_, data_.GetAddress());
+					std::uninitialized_copy_n(rhs.data_ + size_, rhs.size_ - size_, data_ + size_);
 				}
 				size_ = rhs.size_;
 			}
@@ -173,6 +294,28 @@ public:
 		return data_.Capacity();
 	}
 	
+	// Память собственного буфера вектора без учёта памяти, которой владеют сами элементы
+	VectorMemoryUsage MemoryUsage() const noexcept {
+		VectorMemoryUsage usage;
+		usage.used_bytes = size_ * sizeof(T);
+		usage.capacity_bytes = data_.Capacity() * sizeof(T);
+		usage.slack_bytes = usage.capacity_bytes - usage.used_bytes;
+		usage.allocated_bytes = data_.AllocatedBytes();
+		usage.overhead_bytes = usage.allocated_bytes - usage.capacity_bytes;
+		return usage;
+	}
+	
+	// Память буфера вместе с памятью вложенных векторов (и любых элементов с методом DeepMemoryUsage)
+	VectorMemoryUsage DeepMemoryUsage() const noexcept {
+		VectorMemoryUsage usage = MemoryUsage();
+		if constexpr (HasDeepMemoryUsage<T>::value) {
+			for (const T& element : *this) {
+				usage += element.DeepMemoryUsage();
+			}
+		}
+		return usage;
+	}
+	
 	const T& operator[](size_t index) const noexcept {
 		return const_cast<SimpleVector&>(*this)[index];
 	}
@@ -183,17 +326,43 @@ public:
 	}
 	
 	void Swap(SimpleVector& other) noexcept {
+		Instrumentation::template OnSwap<T>(size_);
+		static_cast<Instrumentation&>(other).template OnSwap<T>(other.size_);
 		data_.Swap(other.data_);
 		std::swap(size_, other.size_);
 	}
 	
+	// Уничтожает элементы с конца или добавляет в конец элементы, созданные по умолчанию
 	void Resize(size_t new_size) {
 		if(size_ > new_size) {
-			std::destroy_n(data_.GetAddress(), size_ - new_size);
+			std::destroy_n(data_ + new_size, size_ - new_size);
 		}
 		else if (size_ < new_size){
 			Reserve(new_size);
-			std::uninitialized_value_construct_n(data_.GetAddress(), new_size - size_);
+			if constexpr (IS_ZERO_FILLED) {
+				std::memset(static_cast<void*>(data_ + size_), 0, (new_size - size_) * sizeof(T));
+			}
+			else {
+				std::uninitialized_value_construct_n(data_ + size_, new_size - size_);
+			}
+		}
+		size_ = new_size;
+	}
+	
+	// То же, но новые элементы копируются из value. value может ссылаться на элемент вектора
+	void Resize(size_t new_size, const T& value) {
+		if(size_ > new_size) {
+			std::destroy_n(data_ + new_size, size_ - new_size);
+		}
+		else if (size_ < new_size) {
+			if (new_size > data_.Capacity() && AliasesElements(value)) {
+				// Перенос при росте переместит элемент, на который ссылается value
+				const T copy(value);
+				Resize(new_size, copy);
+				return;
+			}
+			Reserve(new_size);
+			std::uninitialized_fill_n(data_ + size_, new_size - size_, value);
 		}
 		size_ = new_size;
 	}
@@ -203,16 +372,10 @@ public:
 				std::uninitialized_copy_n(&value, 1, data_ + size_);
 		}
 		else {
-			RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+			RawMemory<T, Instrumentation> new_data(Growth::NextCapacity(size_));
 			std::uninitialized_copy_n(&value, 1, new_data + size_);
-			if constexpr (std::is_copy_constructible_v<T> && !std::is_nothrow_move_constructible_v<T>) {
-				std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			else {
-				std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			std::destroy_n(data_.GetAddress(), size_);
-			data_.Swap(new_data);
+			Relocate(data_.GetAddress(), size_, new_data.GetAddress());
+			ReplaceBuffer(new_data);
 		}
 		++size_;
 	}
@@ -221,16 +384,10 @@ public:
 			std::uninitialized_move_n(&value, 1, data_ + size_);
 		}
 		else {
-			RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+			RawMemory<T, Instrumentation> new_data(Growth::NextCapacity(size_));
 			std::uninitialized_move_n(&value, 1, new_data + size_);
-			if constexpr (std::is_copy_constructible_v<T> && !std::is_nothrow_move_constructible_v<T>) {
-				std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			else {
-				std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			std::destroy_n(data_.GetAddress(), size_);
-			data_.Swap(new_data);
+			Relocate(data_.GetAddress(), size_, new_data.GetAddress());
+			ReplaceBuffer(new_data);
 		}
 		++size_;
 	}
@@ -241,23 +398,18 @@ public:
 			new(data_ + size_) T(std::forward<Args>(args)...);
 		}
 		else {
-			RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+			RawMemory<T, Instrumentation> new_data(Growth::NextCapacity(size_));
 			new(new_data + size_) T(std::forward<Args>(args)...);
-			if constexpr (std::is_copy_constructible_v<T> && !std::is_nothrow_move_constructible_v<T>) {
-				std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			else {
-				std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-			}
-			std::destroy_n(data_.GetAddress(), size_);
-			data_.Swap(new_data);
+			Relocate(data_.GetAddress(), size_, new_data.GetAddress());
+			ReplaceBuffer(new_data);
 		}
 		++size_;
 		return this->operator[](size_ - 1);
 	}
 	
 	void PopBack() {
-		std::destroy_at(data_.GetAddress());
+		assert(size_ != 0);
+		std::destroy_at(data_ + size_ - 1);
 		--size_;
 	}
 	
@@ -271,54 +423,41 @@ public:
 	template <typename... Args>
 	iterator Emplace(const_iterator pos, Args&&... args) {
 		size_t dist_to_pos = std::distance(cbegin(), pos);
-		assert(dist_to_pos >= 0);
+		assert(dist_to_pos <= size_);
 
 		if(size_ < Capacity()) {
-			if(dist_to_pos < size_) {
-				T t(std::forward<Args>(args)...);
-				new(end()) T(std::forward<T>(data_[size_ - 1]));
-				std::move_backward(begin() + dist_to_pos, end() - 1, end());
-				data_[dist_to_pos] = std::forward<T>(t);
-			}
-			else {
+			if(dist_to_pos == size_) {
 				new(data_ + dist_to_pos) T(std::forward<Args>(args)...);
 			}
-		}
-		else {
-			RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-			try {
-				new(new_data + dist_to_pos) T(std::forward<Args>(args)...);
-			}
-			catch (...) {
-				new_data.~RawMemory();
-				throw;
-			}
-			if constexpr (!std::is_copy_constructible_v<T> || std::is_nothrow_move_constructible_v<T>) {
-				std::uninitialized_move_n(data_.GetAddress(), dist_to_pos, new_data.GetAddress());
-			}
-			else {
+			else if (CanConstructInGap(args...)) {
+				OpenGap(dist_to_pos);
 				try {
-					std::uninitialized_copy_n(data_.GetAddress(), dist_to_pos, new_data.GetAddress());
+					new(data_ + dist_to_pos) T(std::forward<Args>(args)...);
 				}
-				catch(...) {
-					std::destroy_n(new_data + dist_to_pos, 1);
+				catch (...) {
+					CloseGap(dist_to_pos);
 					throw;
 				}
 			}
+			else {
+				// Аргументы могут ссылаться на сдвигаемые элементы, поэтому значение создаётся до сдвига
+				T t(std::forward<Args>(args)...);
+				new(end()) T(std::move(data_[size_ - 1]));
+				std::move_backward(begin() + dist_to_pos, end() - 1, end());
+				data_[dist_to_pos] = std::move(t);
+			}
+		}
+		else {
+			RawMemory<T, Instrumentation> new_data(Growth::NextCapacity(size_));
+			new(new_data + dist_to_pos) T(std::forward<Args>(args)...);
 			try {
-				if constexpr (!std::is_copy_constructible_v<T> || std::is_nothrow_move_constructible_v<T>) {
-					std::uninitialized_move_n(begin() + dist_to_pos, size_ - dist_to_pos, new_data + dist_to_pos + 1);
-				}
-				else {
-					std::uninitialized_copy_n(begin() + dist_to_pos, size_ - dist_to_pos, new_data + dist_to_pos + 1);
-				}
+				RelocateAround(data_.GetAddress(), size_, dist_to_pos, new_data.GetAddress());
 			}
 			catch(...) {
-				std::destroy_n(new_data.GetAddress(), dist_to_pos);
+				std::destroy_at(new_data + dist_to_pos);
 				throw;
 			}
-			std::destroy_n(data_.GetAddress(), size_);
-			data_.Swap(new_data);
+			ReplaceBuffer(new_data);
 		}
 		++size_;
 		return data_ + dist_to_pos;
@@ -334,25 +473,178 @@ public:
 	}
 
 	~SimpleVector() {
+		Instrumentation::template OnDestroy<T>(size_);
 		std::destroy_n(data_.GetAddress(), size_);
 	}
 	
-	void Reserve(size_t new_capacity) {
+	// С ReserveMode::Prefault страницы буфера отображаются сразу, и добавления в пределах
+	// new_capacity проходят без page fault. Если ёмкости уже хватает, отображается свободный хвост
+	void Reserve(size_t new_capacity, ReserveMode mode = ReserveMode::Lazy) {
 		if (new_capacity <= data_.Capacity()) {
+			if (mode == ReserveMode::Prefault) {
+				PrefaultPages(data_ + size_, (data_.Capacity() - size_) * sizeof(T));
+			}
 			return;
 		}
-		RawMemory<T> new_data(new_capacity);
+		RawMemory<T, Instrumentation> new_data(new_capacity);
+		if (mode == ReserveMode::Prefault) {
+			new_data.Prefault();
+		}
+		Relocate(data_.GetAddress(), size_, new_data.GetAddress());
+		ReplaceBuffer(new_data);
+	}
+	
+	// Добавляет в конец count элементов без инициализации и возвращает указатель на первый из них.
+	// Допустимо только для тривиально копируемых типов: значения записываются в память побайтово
+	T* AppendUninitialized(size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (size_ + count > data_.Capacity()) {
+			Reserve(std::max(size_ + count, Growth::NextCapacity(size_)));
+		}
+		T* first = data_ + size_;
+		size_ += count;
+		return first;
+	}
+
+private:
+	template <typename U, typename = void>
+	struct HasDeepMemoryUsage : std::false_type {
+	};
+	
+	template <typename U>
+	struct HasDeepMemoryUsage<U, std::void_t<decltype(std::declval<const U&>().DeepMemoryUsage())>> : std::true_type {
+	};
+	
+	// Созданный по умолчанию элемент состоит из нулевых байт, и его можно создать через memset.
+	// Только для чисел, перечислений и указателей: структура может содержать указатель на член,
+	// а нулевой указатель на член в Itanium ABI хранится как -1
+	static constexpr bool IS_ZERO_FILLED = std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+	
+	// Хвост сдвигается без исключений: тривиально копируемые элементы побайтово, остальные перемещением
+	static constexpr bool CAN_SHIFT_TAIL = std::is_trivially_copyable_v<T>
+	                                       || (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+	
+	// Лежит ли какой-либо из аргументов внутри элементов вектора
+	template <typename... Args>
+	bool AliasesElements(const Args&... args) const noexcept {
+		if constexpr (sizeof...(Args) == 0) {
+			return false;
+		}
+		else {
+			const std::less<const void*> less;
+			const void* first = data_.GetAddress();
+			const void* last = data_ + size_;
+			return ((!less(std::addressof(args), first) && less(std::addressof(args), last)) || ...);
+		}
+	}
+	
+	// Можно ли сдвинуть хвост и создать элемент сразу в промежутке. Только если сдвиг не бросает
+	// исключений, а аргументы — готовый T или числа и перечисления вне вектора: конструктор из других
+	// аргументов может читать сдвинутые элементы через указатели, и такое обращение не распознать
+	template <typename... Args>
+	bool CanConstructInGap(const Args&... args) const noexcept {
+		if constexpr (CAN_SHIFT_TAIL
+		              && ((sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, T> && ...))
+		                  || (sizeof...(Args) != 0 && ((std::is_arithmetic_v<std::decay_t<Args>>
+		                                                || std::is_enum_v<std::decay_t<Args>>) && ...)))) {
+			return !AliasesElements(args...);
+		}
+		else {
+			return false;
+		}
+	}
+	
+	// Сдвигает элементы [index, size_) на одну позицию вправо и оставляет на месте index сырую память
+	void OpenGap(size_t index) noexcept {
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			std::memmove(data_ + index + 1, data_ + index, (size_ - index) * sizeof(T));
+		}
+		else {
+			new(end()) T(std::move(data_[size_ - 1]));
+			std::move_backward(begin() + index, end() - 1, end());
+			std::destroy_at(data_ + index);
+		}
+	}
+	
+	// Обратная к OpenGap: возвращает элементы на место, если создать элемент в промежутке не удалось
+	void CloseGap(size_t index) noexcept {
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			std::memmove(data_ + index, data_ + index + 1, (size_ - index) * sizeof(T));
+		}
+		else {
+			new(data_ + index) T(std::move(data_[index + 1]));
+			std::move(begin() + index + 2, end() + 1, begin() + index + 1);
+			std::destroy_at(end());
+		}
+	}
+	
+	// Переносит count элементов в неинициализированную память to. Перемещает, если перемещение
+	// не бросает исключений или тип нельзя скопировать, иначе копирует ради строгой гарантии
+	static void Relocate(T* from, size_t count, T* to) {
 		if constexpr (!std::is_copy_constructible_v<T> || std::is_nothrow_move_constructible_v<T>) {
-			std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+			std::uninitialized_move_n(from, count, to);
+			Instrumentation::template OnRelocate<T>(count, true);
 		}
 		else {
-			std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+			std::uninitialized_copy_n(from, count, to);
+			Instrumentation::template OnRelocate<T>(count, false);
+		}
+	}
+	
+	// Переносит count элементов в to за один проход, оставляя незанятой позицию gap: элементы
+	// с индексами от gap попадают на одну позицию правее. Тривиально копируемые элементы переносятся
+	// двумя memcpy, а элементы с небросающим перемещением — циклом без обработчика. В остальных
+	// случаях при исключении уже перенесённые элементы уничтожаются
+	static void RelocateAround(T* from, size_t count, size_t gap, T* to) {
+		assert(gap <= count);
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			// У пустого вектора from == nullptr, а memcpy с нулевым указателем не определён даже для 0 байт
+			if (gap != 0) {
+				std::memcpy(static_cast<void*>(to), from, gap * sizeof(T));
+			}
+			if (count != gap) {
+				std::memcpy(static_cast<void*>(to + gap + 1), from + gap, (count - gap) * sizeof(T));
+			}
+			Instrumentation::template OnRelocate<T>(count, true);
+		}
+		else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+			for (size_t i = 0; i < count; ++i) {
+				new(to + i + (i >= gap)) T(std::move(from[i]));
+			}
+			Instrumentation::template OnRelocate<T>(count, true);
 		}
+		else {
+			// Бросающее перемещение допустимо только для некопируемых типов, как и в Relocate
+			constexpr bool IS_MOVED = !std::is_copy_constructible_v<T>;
+			size_t i = 0;
+			try {
+				for (; i < count; ++i) {
+					if constexpr (IS_MOVED) {
+						new(to + i + (i >= gap)) T(std::move(from[i]));
+					}
+					else {
+						new(to + i + (i >= gap)) T(from[i]);
+					}
+				}
+			}
+			catch (...) {
+				std::destroy_n(to, std::min(i, gap));
+				if (i > gap) {
+					std::destroy_n(to + gap + 1, i - gap);
+				}
+				throw;
+			}
+			Instrumentation::template OnRelocate<T>(count, IS_MOVED);
+		}
+	}
+	
+	// Уничтожает элементы текущего буфера, уже перенесённые в new_data, и заменяет буфер на new_data
+	void ReplaceBuffer(RawMemory<T, Instrumentation>& new_data) noexcept {
+		Instrumentation::template OnGrowth<T>(size_, data_.Capacity(), new_data.Capacity());
 		std::destroy_n(data_.GetAddress(), size_);
 		data_.Swap(new_data);
 	}
-
-private:
-	RawMemory<T> data_;
+	
+	RawMemory<T, Instrumentation> data_;
 	size_t size_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+// "Магическое" число, используемое для отслеживания живости объекта
+inline const uint32_t DEFAULT_COOKIE = 0xdeadbeef;
+
+struct TestObj {
+	TestObj() = default;
+	TestObj(const TestObj& other) = default;
+	TestObj& operator=(const TestObj& other) = default;
+	TestObj(TestObj&& other) = default;
+	TestObj& operator=(TestObj&& other) = default;
+	~TestObj() {
+		cookie = 0;
+	}
+	[[nodiscard]] bool IsAlive() const noexcept {
+		return cookie == DEFAULT_COOKIE;
+	}
+	uint32_t cookie = DEFAULT_COOKIE;
+};
+
+struct Obj {
+	Obj() {
+		if (default_construction_throw_countdown > 0) {
+			if (--default_construction_throw_countdown == 0) {
+				throw std::runtime_error("Oops");
+			}
+		}
+		++num_default_constructed;
+	}
+	
+	explicit Obj(int id)
+			: id(id)  //
+	{
+		++num_constructed_with_id;
+	}
+	
+	Obj(int id, std::string name)
+			: id(id)
+			, name(std::move(name))  //
+	{
+		++num_constructed_with_id_and_name;
+	}
+	
+	Obj(const Obj& other)
+			: id(other.id)  //
+	{
+		if (other.throw_on_copy) {
+			throw std::runtime_error("Oops");
+		}
+		++num_copied;
+	}
+	
+	Obj(Obj&& other) noexcept
+			: id(other.id)  //
+	{
+		++num_moved;
+	}
+	
+	Obj& operator=(const Obj& other) {
+		if (this != &other) {
+			id = other.id;
+			name = other.name;
+			++num_assigned;
+		}
+		return *this;
+	}
+	
+	Obj& operator=(Obj&& other) noexcept {
+		if (this != &other) {
+			id = other.id;
+			name = std::move(other.name);
+			++num_move_assigned;
+		}
+		return *this;
+	}
+	
+	~Obj() {
+		++num_destroyed;
+		id = 0;
+	}
+	
+	static int GetAliveObjectCount() {
+		return num_default_constructed + num_copied + num_moved + num_constructed_with_id
+		       + num_constructed_with_id_and_name - num_destroyed;
+	}
+	
+	static void ResetCounters() {
+		default_construction_throw_countdown = 0;
+		num_default_constructed = 0;
+		num_copied = 0;
+		num_moved = 0;
+		num_destroyed = 0;
+		num_constructed_with_id = 0;
+		num_constructed_with_id_and_name = 0;
+		num_assigned = 0;
+		num_move_assigned = 0;
+	}
+	
+	bool throw_on_copy = false;
+	int id = 0;
+	std::string name;
+	
+	static inline int default_construction_throw_countdown = 0;
+	static inline int num_default_constructed = 0;
+	static inline int num_constructed_with_id = 0;
+	static inline int num_constructed_with_id_and_name = 0;
+	static inline int num_copied = 0;
+	static inline int num_moved = 0;
+	static inline int num_destroyed = 0;
+	static inline int num_assigned = 0;
+	static inline int num_move_assigned = 0;
+};
+
+// Число вызовов конструкторов, присваиваний и деструкторов
+struct LifecycleCounts {
+	int default_constructed = 0;
+	int value_constructed = 0;
+	int copy_constructed = 0;
+	int move_constructed = 0;
+	int copy_assigned = 0;
+	int move_assigned = 0;
+	int destroyed = 0;
+	
+	int Alive() const noexcept {
+		return default_constructed + value_constructed + copy_constructed + move_constructed - destroyed;
+	}
+	
+	bool operator==(const LifecycleCounts& other) const noexcept {
+		return std::tie(default_constructed, value_constructed, copy_constructed, move_constructed,
+		                copy_assigned, move_assigned, destroyed)
+		       == std::tie(other.default_constructed, other.value_constructed, other.copy_constructed,
+		                   other.move_constructed, other.copy_assigned, other.move_assigned, other.destroyed);
+	}
+	
+	bool operator!=(const LifecycleCounts& other) const noexcept {
+		return !(*this == other);
+	}
+};
+
+inline std::ostream& operator<<(std::ostream& out, const LifecycleCounts& counts) {
+	return out << "{default " << counts.default_constructed << ", value " << counts.value_constructed
+	           << ", copy " << counts.copy_constructed << ", move " << counts.move_constructed
+	           << ", copy assign " << counts.copy_assigned << ", move assign " << counts.move_assigned
+	           << ", destroyed " << counts.destroyed << '}';
+}
+
+// Элемент, подсчитывающий свои конструирования, присваивания и уничтожения. Счётчики общие для всех
+// объектов одной специализации шаблона, поэтому разные Tag дают независимые счётчики.
+// При NothrowMove = false перемещение может бросить исключение, и SimpleVector при росте копирует элементы
+template <typename Tag, bool NothrowMove = true>
+struct Counted {
+	Counted() noexcept {
+		++counts.default_constructed;
+	}
+	
+	explicit Counted(int value) noexcept
+			: value(value) {
+		++counts.value_constructed;
+	}
+	
+	Counted(const Counted& other) noexcept
+			: value(other.value) {
+		++counts.copy_constructed;
+	}
+	
+	Counted(Counted&& other) noexcept(NothrowMove)
+			: value(other.value) {
+		++counts.move_constructed;
+	}
+	
+	Counted& operator=(const Counted& other) noexcept {
+		value = other.value;
+		++counts.copy_assigned;
+		return *this;
+	}
+	
+	Counted& operator=(Counted&& other) noexcept(NothrowMove) {
+		value = other.value;
+		++counts.move_assigned;
+		return *this;
+	}
+	
+	~Counted() {
+		++counts.destroyed;
+	}
+	
+	static LifecycleCounts Counts() noexcept {
+		return counts;
+	}
+	
+	static void ResetCounts() noexcept {
+		counts = {};
+	}
+	
+	int value = 0;
+	
+	static inline LifecycleCounts counts;
+};
+
+// Некопируемый элемент с бросающим перемещением. move_throw_countdown задаёт, какое по счёту
+// перемещение бросит исключение, а Alive позволяет проверить, что ни одна копия не утекла
+struct MoveOnlyThrowing {
+	explicit MoveOnlyThrowing(int value) noexcept
+			: value(value) {
+		++alive;
+	}
+	
+	MoveOnlyThrowing(MoveOnlyThrowing&& other)
+			: value(other.value) {
+		if (move_throw_countdown > 0 && --move_throw_countdown == 0) {
+			throw std::runtime_error("Oops");
+		}
+		++alive;
+	}
+	
+	MoveOnlyThrowing(const MoveOnlyThrowing&) = delete;
+	MoveOnlyThrowing& operator=(const MoveOnlyThrowing&) = delete;
+	MoveOnlyThrowing& operator=(MoveOnlyThrowing&&) = default;
+	
+	~MoveOnlyThrowing() {
+		--alive;
+	}
+	
+	static int Alive() noexcept {
+		return alive;
+	}
+	
+	int value;
+	
+	static inline int alive = 0;
+	static inline int move_throw_countdown = 0;
+};
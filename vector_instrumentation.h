@@ -0,0 +1,405 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// Счётчики векторов одного типа элементов. Обновляются атомарно, поэтому векторы
+// могут жить в разных потоках
+struct VectorStats {
+	std::string type_name;
+	size_t element_size = 0;
+	std::atomic<size_t> allocations{0};
+	std::atomic<size_t> deallocations{0};
+	std::atomic<size_t> allocated_bytes{0};
+	std::atomic<size_t> growth_events{0};  // Замены буфера вектора на более ёмкий
+	std::atomic<size_t> moved_elements{0};  // Элементы, перенесённые при росте перемещением
+	std::atomic<size_t> copied_elements{0};  // Элементы, скопированные при росте, так как их перемещение может бросить исключение
+	std::atomic<size_t> relocated_bytes{0};
+	std::atomic<size_t> peak_capacity{0};
+};
+
+// Реестр счётчиков всех типов элементов, для которых включено инструментирование
+class VectorStatsRegistry {
+public:
+	// Реестр не уничтожается, чтобы векторы в статических объектах могли обращаться к нему до конца программы
+	static VectorStatsRegistry& Instance() {
+		static auto* registry = new VectorStatsRegistry;
+		return *registry;
+	}
+
+	template <typename T>
+	VectorStats& Get() {
+		// Счётчики типа создаются один раз при первом обращении и живут до конца программы
+		static VectorStats& stats = Register(TypeName<T>(), sizeof(T));
+		return stats;
+	}
+
+	template <typename Func>
+	void ForEach(Func func) const {
+		std::lock_guard lock(mutex_);
+		for (const auto& stats : stats_) {
+			func(*stats);
+		}
+	}
+
+	// Выводит счётчики всех зарегистрированных типов, по одной строке на тип
+	void Dump(std::ostream& out) const {
+		ForEach([&out](const VectorStats& stats) {
+			out << stats.type_name << " (" << stats.element_size << " B):"
+			    << " allocations " << stats.allocations
+			    << ", deallocations " << stats.deallocations
+			    << ", allocated " << stats.allocated_bytes << " B"
+			    << ", growth " << stats.growth_events
+			    << ", moved " << stats.moved_elements
+			    << ", copied " << stats.copied_elements
+			    << ", relocated " << stats.relocated_bytes << " B"
+			    << ", peak capacity " << stats.peak_capacity << '\n';
+		});
+	}
+
+private:
+	VectorStatsRegistry() = default;
+
+	template <typename T>
+	static std::string TypeName() {
+		const char* name = typeid(T).name();
+#if __has_include(<cxxabi.h>)
+		int status = 0;
+		std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+		if (status == 0) {
+			return demangled.get();
+		}
+#endif
+		return name;
+	}
+
+	VectorStats& Register(std::string type_name, size_t element_size) {
+		std::lock_guard lock(mutex_);
+		auto& stats = *stats_.emplace_back(std::make_unique<VectorStats>());
+		stats.type_name = std::move(type_name);
+		stats.element_size = element_size;
+		return stats;
+	}
+
+	mutable std::mutex mutex_;
+	// Реестр строится на std::vector, поскольку сам SimpleVector зависит от этого заголовка
+	std::vector<std::unique_ptr<VectorStats>> stats_;
+};
+
+class CurrentCallSite;
+
+// Место в исходном коде, где создан вектор. Значения по умолчанию вычисляются в точке вызова
+// конструктора SimpleVector, который принимает CallSite::Current() аргументом по умолчанию
+struct CallSite {
+	const char* file = nullptr;  // nullptr — место неизвестно
+	int line = 0;
+	
+	static constexpr CurrentCallSite Current(const char* file = __builtin_FILE(), int line = __builtin_LINE()) noexcept;
+};
+
+// Результат CallSite::Current(), которым конструкторы SimpleVector принимают место создания.
+// Создать его может только CallSite::Current(), а скопировать нельзя, поэтому у вызывающего кода
+// не бывает значения, неявно превращающегося в вектор
+class CurrentCallSite {
+public:
+	CurrentCallSite(const CurrentCallSite&) = delete;
+	CurrentCallSite& operator=(const CurrentCallSite&) = delete;
+	
+	constexpr operator CallSite() const noexcept {
+		return site_;
+	}
+	
+private:
+	friend struct CallSite;
+	
+	constexpr explicit CurrentCallSite(CallSite site) noexcept
+			: site_(site) {
+	}
+	
+	CallSite site_;
+};
+
+constexpr CurrentCallSite CallSite::Current(const char* file, int line) noexcept {
+	return CurrentCallSite(CallSite{file, line});
+}
+
+// Политика инструментирования по умолчанию: пустые хуки, которые компилятор убирает полностью.
+// Политика — пустой базовый класс SimpleVector, поэтому хуки могут быть и нестатическими,
+// если политике нужно состояние каждого вектора (см. CallSiteProfiling)
+struct NoInstrumentation {
+	template <typename T>
+	static void OnAllocate(size_t /*capacity*/) noexcept {
+	}
+	template <typename T>
+	static void OnDeallocate(size_t /*capacity*/) noexcept {
+	}
+	static void OnConstruct(CallSite /*site*/) noexcept {
+	}
+	template <typename T>
+	static void OnGrowth(size_t /*size*/, size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+	}
+	template <typename T>
+	static void OnRelocate(size_t /*count*/, bool /*moved*/) noexcept {
+	}
+	// Вызывается перед тем, как вектор из size элементов отдаёт буфер другому вектору при обмене или перемещении
+	template <typename T>
+	static void OnSwap(size_t /*size*/) noexcept {
+	}
+	template <typename T>
+	static void OnDestroy(size_t /*size*/) noexcept {
+	}
+};
+
+// Суммарный объём буферов векторов с политикой MemoryCountingInstrumentation или CountingInstrumentation.
+// Учитывается запрошенный размер буфера без округления аллокатора. Векторы с политикой по умолчанию
+// в обычной сборке его не обновляют и не платят за атомарные операции при каждом выделении
+class VectorMemoryCounter {
+public:
+	static size_t AllocatedBytes() noexcept {
+		return bytes_.load(std::memory_order_relaxed);
+	}
+	
+	static size_t Buffers() noexcept {
+		return buffers_.load(std::memory_order_relaxed);
+	}
+
+private:
+	friend struct MemoryCountingInstrumentation;
+	
+	static void Add(size_t bytes) noexcept {
+		bytes_.fetch_add(bytes, std::memory_order_relaxed);
+		buffers_.fetch_add(1, std::memory_order_relaxed);
+	}
+	
+	static void Subtract(size_t bytes) noexcept {
+		bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+		buffers_.fetch_sub(1, std::memory_order_relaxed);
+	}
+	
+	static inline std::atomic<size_t> bytes_{0};
+	static inline std::atomic<size_t> buffers_{0};
+};
+
+// Политика, учитывающая только объём буферов в VectorMemoryCounter
+struct MemoryCountingInstrumentation : NoInstrumentation {
+	template <typename T>
+	static void OnAllocate(size_t capacity) noexcept {
+		VectorMemoryCounter::Add(capacity * sizeof(T));
+	}
+	template <typename T>
+	static void OnDeallocate(size_t capacity) noexcept {
+		VectorMemoryCounter::Subtract(capacity * sizeof(T));
+	}
+};
+
+// Политика, собирающая счётчики в VectorStatsRegistry и объём буферов в VectorMemoryCounter
+struct CountingInstrumentation : MemoryCountingInstrumentation {
+	template <typename T>
+	static void OnAllocate(size_t capacity) noexcept {
+		MemoryCountingInstrumentation::OnAllocate<T>(capacity);
+		VectorStats& stats = VectorStatsRegistry::Instance().Get<T>();
+		stats.allocations.fetch_add(1, std::memory_order_relaxed);
+		stats.allocated_bytes.fetch_add(capacity * sizeof(T), std::memory_order_relaxed);
+		size_t peak = stats.peak_capacity.load(std::memory_order_relaxed);
+		while (peak < capacity && !stats.peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+		}
+	}
+	template <typename T>
+	static void OnDeallocate(size_t capacity) noexcept {
+		MemoryCountingInstrumentation::OnDeallocate<T>(capacity);
+		VectorStatsRegistry::Instance().Get<T>().deallocations.fetch_add(1, std::memory_order_relaxed);
+	}
+	template <typename T>
+	static void OnGrowth(size_t /*size*/, size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+		VectorStatsRegistry::Instance().Get<T>().growth_events.fetch_add(1, std::memory_order_relaxed);
+	}
+	template <typename T>
+	static void OnRelocate(size_t count, bool moved) noexcept {
+		VectorStats& stats = VectorStatsRegistry::Instance().Get<T>();
+		(moved ? stats.moved_elements : stats.copied_elements).fetch_add(count, std::memory_order_relaxed);
+		stats.relocated_bytes.fetch_add(count * sizeof(T), std::memory_order_relaxed);
+	}
+};
+
+// Рекомендация ёмкости для одного места создания векторов
+struct CapacityRecommendation {
+	std::string file;
+	int line = 0;
+	size_t vectors = 0;  // Сколько векторов создано здесь и уже уничтожено
+	size_t growth_events = 0;  // Сколько раз они заменяли буфер
+	size_t median_size = 0;  // Медиана и максимум наибольшего размера вектора за время жизни
+	size_t max_size = 0;
+	size_t reserve = 0;  // Рекомендуемый аргумент Reserve сразу после создания; 0 — резервировать не нужно
+	size_t estimated_growth_events = 0;  // Ожидаемое число замен буфера после добавления Reserve
+};
+
+// Распределения наибольших размеров векторов по местам их создания
+class CallSiteRegistry {
+public:
+	// На каждое место хранится не больше SAMPLE_LIMIT размеров, выбранных равновероятно (reservoir sampling)
+	static constexpr size_t SAMPLE_LIMIT = 4096;
+	
+	static CallSiteRegistry& Instance() {
+		static auto* registry = new CallSiteRegistry;
+		return *registry;
+	}
+	
+	void Record(CallSite site, size_t peak_size, size_t growth_events) {
+		std::lock_guard lock(mutex_);
+		Site& stats = sites_[{site.file, site.line}];
+		++stats.vectors;
+		stats.growth_events += growth_events;
+		if (stats.samples.size() < SAMPLE_LIMIT) {
+			stats.samples.push_back(peak_size);
+		} else {
+			random_ = random_ * 6364136223846793005u + 1442695040888963407u;
+			const size_t index = (random_ >> 33) % stats.vectors;
+			if (index < SAMPLE_LIMIT) {
+				stats.samples[index] = peak_size;
+			}
+		}
+	}
+	
+	// Для каждого места выбирает ёмкость, которой хватает доле coverage созданных там векторов.
+	// Места упорядочены по убыванию числа замен буфера
+	std::vector<CapacityRecommendation> Recommend(double coverage = 0.9) const {
+		std::vector<CapacityRecommendation> result;
+		std::lock_guard lock(mutex_);
+		for (const auto& [key, stats] : sites_) {
+			std::vector<size_t> sizes = stats.samples;
+			std::sort(sizes.begin(), sizes.end());
+			CapacityRecommendation recommendation;
+			recommendation.file = key.first;
+			recommendation.line = key.second;
+			recommendation.vectors = stats.vectors;
+			recommendation.growth_events = stats.growth_events;
+			recommendation.median_size = sizes[(sizes.size() - 1) / 2];
+			recommendation.max_size = sizes.back();
+			const auto index = static_cast<size_t>(std::ceil(coverage * static_cast<double>(sizes.size()))) - 1;
+			recommendation.reserve = sizes[std::min(index, sizes.size() - 1)];
+			double estimated = 0;
+			for (const size_t size : sizes) {
+				estimated += static_cast<double>(EstimateGrowthEvents(size, recommendation.reserve));
+			}
+			recommendation.estimated_growth_events = static_cast<size_t>(
+					estimated * static_cast<double>(stats.vectors) / static_cast<double>(sizes.size()) + 0.5);
+			result.push_back(std::move(recommendation));
+		}
+		std::sort(result.begin(), result.end(), [](const CapacityRecommendation& lhs, const CapacityRecommendation& rhs) {
+			return lhs.growth_events > rhs.growth_events;
+		});
+		return result;
+	}
+	
+	void Report(std::ostream& out, double coverage = 0.9) const {
+		out << "Reserve recommendations covering " << coverage * 100 << "% of vectors per call site:\n";
+		for (const CapacityRecommendation& site : Recommend(coverage)) {
+			out << site.file << ':' << site.line << ": vectors " << site.vectors << ", growth " << site.growth_events
+			    << ", size median " << site.median_size << " max " << site.max_size;
+			if (site.reserve != 0 && site.estimated_growth_events < site.growth_events) {
+				out << " -> Reserve(" << site.reserve << "), growth ~" << site.estimated_growth_events;
+			}
+			out << '\n';
+		}
+	}
+	
+	void Clear() {
+		std::lock_guard lock(mutex_);
+		sites_.clear();
+	}
+
+private:
+	struct Site {
+		size_t vectors = 0;
+		size_t growth_events = 0;
+		std::vector<size_t> samples;
+	};
+	
+	CallSiteRegistry() = default;
+	
+	// Число замен буфера вектора, выросшего до size после Reserve(reserve), при удвоении ёмкости
+	static size_t EstimateGrowthEvents(size_t size, size_t reserve) noexcept {
+		if (reserve == 0) {
+			size_t events = 0;
+			for (size_t capacity = 0; capacity < size; capacity = capacity == 0 ? 1 : capacity * 2) {
+				++events;
+			}
+			return events;
+		}
+		size_t events = 1;
+		for (size_t capacity = reserve; capacity < size; capacity *= 2) {
+			++events;
+		}
+		return events;
+	}
+	
+	mutable std::mutex mutex_;
+	std::map<std::pair<std::string, int>, Site> sites_;
+	uint64_t random_ = 0x853c49e6748fea9bu;
+};
+
+// Политика профилирования по местам создания. Каждый вектор, созданный конструктором по умолчанию
+// или с размером, запоминает место создания, число замен буфера и наибольший размер, замеченный
+// при росте, обмене и уничтожении, а при уничтожении передаёт их в CallSiteRegistry.
+// Копии и векторы, созданные перемещением, не учитываются: их буфер выделяется под готовый размер
+// или достаётся от другого вектора
+class CallSiteProfiling : public NoInstrumentation {
+public:
+	void OnConstruct(CallSite site) noexcept {
+		site_ = site;
+	}
+	
+	template <typename T>
+	void OnGrowth(size_t size, size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+		++growth_events_;
+		peak_size_ = std::max(peak_size_, size);
+	}
+	
+	template <typename T>
+	void OnSwap(size_t size) noexcept {
+		peak_size_ = std::max(peak_size_, size);
+	}
+	
+	template <typename T>
+	void OnDestroy(size_t size) noexcept {
+		if (site_.file == nullptr) {
+			return;
+		}
+		try {
+			CallSiteRegistry::Instance().Record(site_, std::max(peak_size_, size), growth_events_);
+		} catch (...) {
+			// Нехватка памяти под статистику не должна влиять на программу
+		}
+	}
+
+private:
+	CallSite site_;
+	size_t growth_events_ = 0;
+	size_t peak_size_ = 0;
+};
+
+// Политика векторов, для которых она не указана явно. Сборка с -DSIMPLE_VECTOR_INSTRUMENTATION
+// включает счётчики для всех таких векторов программы, а с -DSIMPLE_VECTOR_PROFILE_CALL_SITES —
+// профилирование по местам создания
+#if defined(SIMPLE_VECTOR_PROFILE_CALL_SITES)
+using DefaultVectorInstrumentation = CallSiteProfiling;
+#elif defined(SIMPLE_VECTOR_INSTRUMENTATION)
+using DefaultVectorInstrumentation = CountingInstrumentation;
+#else
+using DefaultVectorInstrumentation = NoInstrumentation;
+#endif
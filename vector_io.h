@@ -0,0 +1,224 @@
+#pragma once
+#include "simple_vector.h"
+#include "vector_view.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <istream>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Байтовые буферы: SimpleVector<char>, SimpleVector<unsigned char>, SimpleVector<uint8_t> и т.п.
+template <typename T>
+inline constexpr bool IsByteType = sizeof(T) == 1 && std::is_trivially_copyable_v<T>;
+
+namespace detail {
+
+	// Сколько байтов читается во временный буфер, когда свободной ёмкости нет. Ёмкость растёт,
+	// только если что-то прочитано, поэтому проверка конца файла не удваивает буфер
+	inline constexpr size_t READ_PROBE_BYTES = 4096;
+
+	// Дописывает прочитанные во временный буфер байты, наращивая ёмкость по схеме PushBack
+	template <typename T>
+	void AppendProbe(SimpleVector<T>& buffer, const char* probe, size_t count) {
+		const size_t old_size = buffer.Size();
+		buffer.Reserve(std::max(old_size + count, DoublingGrowth::NextCapacity(old_size)));
+		std::memcpy(buffer.AppendUninitialized(count), probe, count);
+	}
+
+}  // namespace detail
+
+// Выполняет один вызов read, дописывая не более max_bytes байтов прямо в свободную ёмкость буфера.
+// Если её нет, читает не более READ_PROBE_BYTES во временный буфер и только тогда наращивает ёмкость
+// по той же схеме, что и в PushBack. Возвращает число прочитанных байтов, 0 означает конец файла
+template <typename T>
+size_t ReadAppend(SimpleVector<T>& buffer, int fd, size_t max_bytes) {
+	static_assert(IsByteType<T>, "ReadAppend works with byte buffers only");
+	const size_t old_size = buffer.Size();
+	const size_t spare = buffer.Capacity() - old_size;
+	char probe[detail::READ_PROBE_BYTES];
+	const size_t limit = std::min(max_bytes, spare != 0 ? spare : sizeof(probe));
+	void* target = spare != 0 ? static_cast<void*>(buffer.AppendUninitialized(limit)) : probe;
+	ssize_t result;
+	do {
+		result = ::read(fd, target, limit);
+	} while (result < 0 && errno == EINTR);
+	const int error = errno;
+	const size_t received = result > 0 ? static_cast<size_t>(result) : 0;
+	if (spare != 0) {
+		buffer.Resize(old_size + received);
+	} else if (received != 0) {
+		detail::AppendProbe(buffer, probe, received);
+	}
+	if (result < 0) {
+		throw std::system_error(error, std::generic_category(), "read");
+	}
+	return received;
+}
+
+// Дочитывает поток до конца, заполняя сначала свободную ёмкость буфера, а затем наращивая её.
+// Возвращает число прочитанных байтов
+template <typename T>
+size_t ReadAppend(SimpleVector<T>& buffer, std::istream& in) {
+	static_assert(IsByteType<T>, "ReadAppend works with byte buffers only");
+	size_t total = 0;
+	while (in) {
+		const size_t old_size = buffer.Size();
+		const size_t spare = buffer.Capacity() - old_size;
+		size_t received;
+		if (spare != 0) {
+			T* tail = buffer.AppendUninitialized(spare);
+			in.read(reinterpret_cast<char*>(tail), static_cast<std::streamsize>(spare));
+			received = static_cast<size_t>(in.gcount());
+			buffer.Resize(old_size + received);
+		} else {
+			char probe[detail::READ_PROBE_BYTES];
+			in.read(probe, sizeof(probe));
+			received = static_cast<size_t>(in.gcount());
+			if (received != 0) {
+				detail::AppendProbe(buffer, probe, received);
+			}
+		}
+		total += received;
+	}
+	if (in.bad()) {
+		throw std::system_error(std::make_error_code(std::io_errc::stream), "ReadAppend");
+	}
+	return total;
+}
+
+namespace detail {
+
+	// Сколько байтов прорежённого представления собирается для одного вызова write
+	inline constexpr size_t WRITE_GATHER_BYTES = 4096;
+
+	// Записывает size байтов целиком, повторяя write после частичной записи
+	inline void WriteBytes(int fd, const void* data, size_t size) {
+		const auto* position = static_cast<const char*>(data);
+		while (size != 0) {
+			const ssize_t written = ::write(fd, position, size);
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::system_error(errno, std::generic_category(), "write");
+			}
+			position += written;
+			size -= static_cast<size_t>(written);
+		}
+	}
+
+}  // namespace detail
+
+// Записывает содержимое буфера целиком, повторяя write после частичной записи. Элементы прорежённого
+// представления собираются порциями по WRITE_GATHER_BYTES, и промежутки между ними не записываются
+template <typename T>
+void WriteAll(int fd, VectorView<T> data) {
+	static_assert(IsByteType<T>, "WriteAll works with byte buffers only");
+	if (data.IsContiguous()) {
+		detail::WriteBytes(fd, data.Data(), data.Size());
+		return;
+	}
+	T gathered[detail::WRITE_GATHER_BYTES];
+	for (size_t offset = 0; offset < data.Size(); offset += detail::WRITE_GATHER_BYTES) {
+		const VectorView<T> part = data.Subview(offset, detail::WRITE_GATHER_BYTES);
+		std::copy(part.begin(), part.end(), gathered);
+		detail::WriteBytes(fd, gathered, part.Size());
+	}
+}
+
+template <typename T>
+void WriteAll(int fd, const SimpleVector<T>& data) {
+	WriteAll(fd, VectorView<T>(data));
+}
+
+// Записывает записи подряд, передавая ядру до IOV_MAX буферов за один вызов writev.
+// Возвращает число записанных байтов
+template <typename T>
+size_t WriteVectored(int fd, const SimpleVector<SimpleVector<T>>& records) {
+	static_assert(IsByteType<T>, "WriteVectored works with byte buffers only");
+	iovec iov[IOV_MAX];
+	size_t total = 0;
+	size_t next = 0;
+	while (next < records.Size()) {
+		int count = 0;
+		for (; next < records.Size() && count < IOV_MAX; ++next) {
+			if (records[next].Size() != 0) {
+				iov[count++] = {const_cast<T*>(records[next].begin()), records[next].Size()};
+			}
+		}
+		for (iovec* first = iov; count != 0;) {
+			const ssize_t written = ::writev(fd, first, count);
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::system_error(errno, std::generic_category(), "writev");
+			}
+			total += static_cast<size_t>(written);
+			// После частичной записи продолжаем с первого недописанного байта
+			size_t rest = static_cast<size_t>(written);
+			for (; count != 0 && rest >= first->iov_len; ++first, --count) {
+				rest -= first->iov_len;
+			}
+			if (count != 0) {
+				first->iov_base = static_cast<char*>(first->iov_base) + rest;
+				first->iov_len -= rest;
+			}
+		}
+	}
+	return total;
+}
+
+// Читает данные подряд в свободную ёмкость записей (Capacity() - Size()), заполняя их по порядку
+// через readv, пока не кончится ёмкость или файл. Записи нужно заранее зарезервировать.
+// Возвращает число прочитанных байтов
+template <typename T>
+size_t ReadVectored(int fd, SimpleVector<SimpleVector<T>>& records) {
+	static_assert(IsByteType<T>, "ReadVectored works with byte buffers only");
+	iovec iov[IOV_MAX];
+	size_t total = 0;
+	size_t next = 0;
+	while (next < records.Size()) {
+		int count = 0;
+		size_t last = next;
+		for (; last < records.Size() && count < IOV_MAX; ++last) {
+			SimpleVector<T>& record = records[last];
+			if (record.Size() != record.Capacity()) {
+				iov[count++] = {record.end(), record.Capacity() - record.Size()};
+			}
+		}
+		if (count == 0) {
+			next = last;
+			continue;
+		}
+		ssize_t received;
+		do {
+			received = ::readv(fd, iov, count);
+		} while (received < 0 && errno == EINTR);
+		if (received < 0) {
+			throw std::system_error(errno, std::generic_category(), "readv");
+		}
+		if (received == 0) {
+			break;
+		}
+		total += static_cast<size_t>(received);
+		// Байты уже лежат в хвостах записей, остаётся увеличить их размеры в пределах ёмкости
+		for (size_t rest = static_cast<size_t>(received); rest != 0; ++next) {
+			SimpleVector<T>& record = records[next];
+			const size_t appended = std::min(rest, record.Capacity() - record.Size());
+			record.AppendUninitialized(appended);
+			rest -= appended;
+			if (record.Size() != record.Capacity()) {
+				break;
+			}
+		}
+	}
+	return total;
+}
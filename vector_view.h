@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Невладеющее представление для чтения последовательности элементов: указатель, размер и шаг.
+// Строится из SimpleVector, MappedVector или произвольного буфера без копирования данных.
+// Представление действительно, пока жив исходный буфер и не произошла его реаллокация
+template <typename T>
+class VectorView {
+public:
+	class Iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+
+		Iterator() = default;
+
+		Iterator(const T* data, size_t index, size_t stride) noexcept
+				: data_(data)
+				, index_(index)
+				, stride_(stride) {
+		}
+
+		reference operator*() const noexcept {
+			return data_[index_ * stride_];
+		}
+		pointer operator->() const noexcept {
+			return &**this;
+		}
+		reference operator[](difference_type n) const noexcept {
+			return *(*this + n);
+		}
+
+		Iterator& operator++() noexcept {
+			++index_;
+			return *this;
+		}
+		Iterator operator++(int) noexcept {
+			Iterator copy = *this;
+			++*this;
+			return copy;
+		}
+		Iterator& operator--() noexcept {
+			--index_;
+			return *this;
+		}
+		Iterator operator--(int) noexcept {
+			Iterator copy = *this;
+			--*this;
+			return copy;
+		}
+		Iterator& operator+=(difference_type n) noexcept {
+			index_ += n;
+			return *this;
+		}
+		Iterator& operator-=(difference_type n) noexcept {
+			return *this += -n;
+		}
+		friend Iterator operator+(Iterator it, difference_type n) noexcept {
+			return it += n;
+		}
+		friend Iterator operator+(difference_type n, Iterator it) noexcept {
+			return it += n;
+		}
+		friend Iterator operator-(Iterator it, difference_type n) noexcept {
+			return it -= n;
+		}
+		friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+		}
+
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return lhs.index_ == rhs.index_;
+		}
+		friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return lhs.index_ != rhs.index_;
+		}
+		friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return lhs.index_ < rhs.index_;
+		}
+		friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return rhs < lhs;
+		}
+		friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return !(rhs < lhs);
+		}
+		friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+			return !(lhs < rhs);
+		}
+
+	private:
+		// Позиция хранится индексом: адрес за последним элементом прорежённого представления
+		// может выходить за границы буфера
+		const T* data_ = nullptr;
+		size_t index_ = 0;
+		size_t stride_ = 1;
+	};
+
+	using iterator = Iterator;
+	using const_iterator = Iterator;
+
+	VectorView() noexcept = default;
+
+	// stride задаёт расстояние между соседними элементами представления в элементах буфера
+	VectorView(const T* data, size_t size, size_t stride = 1) noexcept
+			: data_(data)
+			, size_(size)
+			, stride_(stride)
+	{
+		assert(stride_ > 0);
+	}
+
+	// Неявное преобразование из любого непрерывного контейнера с begin() и Size(),
+	// например SimpleVector<T> или MappedVector<T>
+	template <typename Container,
+	          typename = std::enable_if_t<
+	                  std::is_convertible_v<decltype(std::declval<const Container&>().begin()), const T*>
+	                  && std::is_convertible_v<decltype(std::declval<const Container&>().Size()), size_t>>>
+	VectorView(const Container& container) noexcept
+			: VectorView(container.begin(), container.Size()) {
+	}
+
+	Iterator begin() const noexcept {
+		return {data_, 0, stride_};
+	}
+	Iterator end() const noexcept {
+		return {data_, size_, stride_};
+	}
+	Iterator cbegin() const noexcept {
+		return begin();
+	}
+	Iterator cend() const noexcept {
+		return end();
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	bool IsEmpty() const noexcept {
+		return size_ == 0;
+	}
+
+	size_t Stride() const noexcept {
+		return stride_;
+	}
+
+	// Элементы лежат в памяти подряд, и представление можно передавать туда, где ждут указатель и размер
+	bool IsContiguous() const noexcept {
+		return stride_ == 1 || size_ <= 1;
+	}
+
+	const T* Data() const noexcept {
+		return data_;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		assert(index < size_);
+		return data_[index * stride_];
+	}
+
+	// Возвращает не более count элементов, начиная с позиции offset
+	VectorView Subview(size_t offset, size_t count = static_cast<size_t>(-1)) const noexcept {
+		assert(offset <= size_);
+		return {data_ + offset * stride_, std::min(count, size_ - offset), stride_};
+	}
+
+	// Возвращает каждый step-й элемент, начиная с первого
+	VectorView EveryNth(size_t step) const noexcept {
+		assert(step > 0);
+		return {data_, (size_ + step - 1) / step, stride_ * step};
+	}
+
+private:
+	const T* data_ = nullptr;
+	size_t size_ = 0;
+	size_t stride_ = 1;
+};